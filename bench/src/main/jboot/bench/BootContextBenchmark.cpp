@@ -0,0 +1,81 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/bench/BootContextBenchmark.h>
+#include <jboot/boot/context/Context.h>
+#include <jboot/object/Context.h>
+
+#include <esl/object/Context.h>
+#include <esl/processing/Procedure.h>
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+
+namespace jboot {
+namespace bench {
+
+namespace {
+class NoOp : public esl::processing::Procedure {
+public:
+	void procedureRun(esl::object::Context&) override {
+	}
+};
+
+void runEntries(Result& result, std::size_t entries) {
+	std::vector<std::pair<std::string, std::string>> parameters {
+		{ "entries", std::to_string(entries) }
+	};
+
+	try {
+		boot::context::Context bootContext({});
+		for(std::size_t i = 0; i < entries; ++i) {
+			bootContext.addObject("", std::unique_ptr<esl::processing::Procedure>(new NoOp));
+		}
+
+		const std::size_t runs = entries >= 1000 ? 10000 : 100000;
+		object::Context context;
+
+		/* first call initializes the context */
+		bootContext.procedureRun(context);
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for(std::size_t i = 0; i < runs; ++i) {
+			bootContext.procedureRun(context);
+		}
+		result.add("boot-context/procedure-run", parameters, runs, std::chrono::steady_clock::now() - startTime);
+	}
+	catch(const std::exception& e) {
+		result.addError("boot-context/procedure-run", parameters, e.what());
+	}
+}
+} /* anonymous namespace */
+
+void BootContextBenchmark::run(Result& result) {
+	if(!result.isSelected("boot-context")) {
+		return;
+	}
+
+	for(std::size_t entries : { 1, 10, 100, 1000 }) {
+		runEntries(result, entries);
+	}
+}
+
+} /* namespace bench */
+} /* namespace jboot */
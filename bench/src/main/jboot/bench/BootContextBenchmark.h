@@ -0,0 +1,36 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_BENCH_BOOTCONTEXTBENCHMARK_H_
+#define JBOOT_BENCH_BOOTCONTEXTBENCHMARK_H_
+
+#include <jboot/bench/Result.h>
+
+namespace jboot {
+namespace bench {
+
+class BootContextBenchmark final {
+public:
+	BootContextBenchmark() = delete;
+	static void run(Result& result);
+};
+
+} /* namespace bench */
+} /* namespace jboot */
+
+#endif /* JBOOT_BENCH_BOOTCONTEXTBENCHMARK_H_ */
@@ -0,0 +1,79 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/bench/ConfigContextBenchmark.h>
+#include <jboot/config/context/Context.h>
+
+#include <chrono>
+#include <exception>
+#include <string>
+
+namespace jboot {
+namespace bench {
+
+namespace {
+std::string makeConfiguration(std::size_t objects) {
+	std::string configuration = "<jboot>\n";
+
+	for(std::size_t i = 0; i < objects; ++i) {
+		std::string id = std::to_string(i);
+		configuration += "  <object id=\"object-" + id + "\" implementation=\"jboot/bench/Object\">\n";
+		configuration += "    <parameter key=\"key-1\" value=\"value-" + id + "\"/>\n";
+		configuration += "    <parameter key=\"key-2\" value=\"value-" + id + "\"/>\n";
+		configuration += "  </object>\n";
+		configuration += "  <procedure ref-id=\"object-" + id + "\"/>\n";
+	}
+
+	configuration += "</jboot>\n";
+	return configuration;
+}
+
+void runObjects(Result& result, std::size_t objects) {
+	const std::string configuration = makeConfiguration(objects);
+	std::vector<std::pair<std::string, std::string>> parameters {
+		{ "objects", std::to_string(objects) },
+		{ "bytes", std::to_string(configuration.size()) }
+	};
+
+	try {
+		const std::size_t runs = objects >= 10000 ? 5 : 50;
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for(std::size_t i = 0; i < runs; ++i) {
+			config::context::Context config(configuration);
+		}
+		result.add("config-context/parse", parameters, runs, std::chrono::steady_clock::now() - startTime);
+	}
+	catch(const std::exception& e) {
+		result.addError("config-context/parse", parameters, e.what());
+	}
+}
+} /* anonymous namespace */
+
+void ConfigContextBenchmark::run(Result& result) {
+	if(!result.isSelected("config-context")) {
+		return;
+	}
+
+	for(std::size_t objects : { 100, 1000, 10000 }) {
+		runObjects(result, objects);
+	}
+}
+
+} /* namespace bench */
+} /* namespace jboot */
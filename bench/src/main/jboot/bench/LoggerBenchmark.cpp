@@ -0,0 +1,87 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/bench/LoggerBenchmark.h>
+#include <jboot/boot/logging/Config.h>
+#include <jboot/Logger.h>
+
+#include <chrono>
+#include <exception>
+#include <sstream>
+#include <string>
+
+namespace jboot {
+namespace bench {
+
+namespace {
+Logger logger("jboot::bench::LoggerBenchmark");
+
+void runFlush(Result& result, std::size_t messages) {
+	std::vector<std::pair<std::string, std::string>> parameters {
+		{ "messages", std::to_string(messages) }
+	};
+
+	try {
+		const std::size_t runs = 1000;
+		std::chrono::nanoseconds elapsed(0);
+
+		for(std::size_t i = 0; i < runs; ++i) {
+			for(std::size_t j = 0; j < messages; ++j) {
+				logger.info << "benchmark message " << j << "\n";
+			}
+
+			std::stringstream strStream;
+			std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+			Logger::flush(strStream);
+			elapsed += std::chrono::steady_clock::now() - startTime;
+		}
+
+		result.add("logger/flush", parameters, runs, elapsed);
+	}
+	catch(const std::exception& e) {
+		result.addError("logger/flush", parameters, e.what());
+	}
+}
+} /* anonymous namespace */
+
+void LoggerBenchmark::run(Result& result) {
+	if(!result.isSelected("logger")) {
+		return;
+	}
+
+	try {
+		boot::logging::Config config({});
+		config.addData(
+				"<esl-logger>\n"
+				"  <layout id=\"default\" implementation=\"jboot/logging/DefaultLayout\"/>\n"
+				"  <appender name=\"membuffer\" implementation=\"jboot/logging/MemBufferAppender\" layout=\"default\" record=\"ALL\"/>\n"
+				"  <setting scope=\"jboot::bench::LoggerBenchmark\" level=\"INFO\"/>\n"
+				"</esl-logger>\n");
+	}
+	catch(const std::exception& e) {
+		result.addError("logger/flush", {}, std::string("logging configuration failed: ") + e.what());
+		return;
+	}
+
+	for(std::size_t messages : { 0, 10, 100, 1000 }) {
+		runFlush(result, messages);
+	}
+}
+
+} /* namespace bench */
+} /* namespace jboot */
@@ -0,0 +1,85 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/bench/ObjectContextBenchmark.h>
+#include <jboot/object/Context.h>
+
+#include <esl/object/Object.h>
+#include <esl/object/Value.h>
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jboot {
+namespace bench {
+
+namespace {
+void runObjects(Result& result, std::size_t objects) {
+	std::vector<std::pair<std::string, std::string>> parameters {
+		{ "objects", std::to_string(objects) }
+	};
+
+	try {
+		std::vector<std::string> ids;
+		for(std::size_t i = 0; i < objects; ++i) {
+			ids.push_back("object-" + std::to_string(i));
+		}
+
+		object::Context context;
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for(const auto& id : ids) {
+			context.addObject(id, std::unique_ptr<esl::object::Object>(new esl::object::Value<std::size_t>(0)));
+		}
+		result.add("object-context/add", parameters, objects, std::chrono::steady_clock::now() - startTime);
+
+		const std::size_t lookups = 1000000;
+		std::size_t found = 0;
+		startTime = std::chrono::steady_clock::now();
+		for(std::size_t i = 0; i < lookups; ++i) {
+			if(context.findObject<esl::object::Object>(ids[(i * 7919) % objects])) {
+				++found;
+			}
+		}
+		std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - startTime;
+		if(found != lookups) {
+			throw std::runtime_error("lookup failed");
+		}
+		result.add("object-context/find", parameters, lookups, elapsed);
+	}
+	catch(const std::exception& e) {
+		result.addError("object-context", parameters, e.what());
+	}
+}
+} /* anonymous namespace */
+
+void ObjectContextBenchmark::run(Result& result) {
+	if(!result.isSelected("object-context")) {
+		return;
+	}
+
+	for(std::size_t objects : { 10, 100, 1000, 10000 }) {
+		runObjects(result, objects);
+	}
+}
+
+} /* namespace bench */
+} /* namespace jboot */
@@ -0,0 +1,108 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/bench/Result.h>
+
+#include <cstdio>
+
+namespace jboot {
+namespace bench {
+
+Result::Result(std::ostream& aOStream, const std::string& aFilter)
+: oStream(aOStream),
+  filter(aFilter)
+{ }
+
+bool Result::isSelected(const std::string& benchmark) const {
+	return filter.empty() || benchmark.compare(0, filter.size(), filter) == 0;
+}
+
+void Result::add(const std::string& benchmark, const std::vector<std::pair<std::string, std::string>>& parameters,
+		std::uint64_t operations, std::chrono::nanoseconds elapsed, const processing::procedure::Histogram* latency) {
+	const double seconds = std::chrono::duration<double>(elapsed).count();
+
+	printHeader(benchmark, parameters);
+	oStream << ",\"operations\":" << operations;
+	oStream << ",\"elapsed_ns\":" << elapsed.count();
+	oStream << ",\"ns_per_op\":" << (operations == 0 ? 0.0 : static_cast<double>(elapsed.count()) / static_cast<double>(operations));
+	oStream << ",\"ops_per_s\":" << (seconds > 0.0 ? static_cast<double>(operations) / seconds : 0.0);
+	if(latency) {
+		oStream << ",\"latency_ns\":{";
+		oStream << "\"min\":" << latency->getMin();
+		oStream << ",\"mean\":" << latency->getMean();
+		oStream << ",\"p50\":" << latency->getValueAtPercentile(50.0);
+		oStream << ",\"p90\":" << latency->getValueAtPercentile(90.0);
+		oStream << ",\"p99\":" << latency->getValueAtPercentile(99.0);
+		oStream << ",\"p99.9\":" << latency->getValueAtPercentile(99.9);
+		oStream << ",\"max\":" << latency->getMax();
+		oStream << "}";
+	}
+	oStream << "}\n";
+	oStream.flush();
+}
+
+void Result::addError(const std::string& benchmark, const std::vector<std::pair<std::string, std::string>>& parameters, const std::string& message) {
+	printHeader(benchmark, parameters);
+	oStream << ",\"error\":\"" << escape(message) << "\"}\n";
+	oStream.flush();
+}
+
+void Result::printHeader(const std::string& benchmark, const std::vector<std::pair<std::string, std::string>>& parameters) {
+	oStream << "{\"jboot\":\"1.5.0\",\"benchmark\":\"" << escape(benchmark) << "\"";
+	oStream << ",\"parameters\":{";
+	for(std::size_t i = 0; i < parameters.size(); ++i) {
+		oStream << (i == 0 ? "" : ",") << "\"" << escape(parameters[i].first) << "\":\"" << escape(parameters[i].second) << "\"";
+	}
+	oStream << "}";
+}
+
+std::string Result::escape(const std::string& str) {
+	std::string rv;
+
+	for(char c : str) {
+		switch(c) {
+		case '"':
+			rv += "\\\"";
+			break;
+		case '\\':
+			rv += "\\\\";
+			break;
+		case '\n':
+			rv += "\\n";
+			break;
+		case '\t':
+			rv += "\\t";
+			break;
+		default:
+			if(static_cast<unsigned char>(c) < 0x20) {
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+				rv += buffer;
+			}
+			else {
+				rv += c;
+			}
+			break;
+		}
+	}
+
+	return rv;
+}
+
+} /* namespace bench */
+} /* namespace jboot */
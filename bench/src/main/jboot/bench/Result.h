@@ -0,0 +1,56 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_BENCH_RESULT_H_
+#define JBOOT_BENCH_RESULT_H_
+
+#include <jboot/processing/procedure/Histogram.h>
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace bench {
+
+/* Writes one JSON object per line, so results of different jboot releases can be compared by scripts. */
+class Result {
+public:
+	Result(std::ostream& oStream, const std::string& filter);
+
+	bool isSelected(const std::string& benchmark) const;
+
+	void add(const std::string& benchmark, const std::vector<std::pair<std::string, std::string>>& parameters,
+			std::uint64_t operations, std::chrono::nanoseconds elapsed, const processing::procedure::Histogram* latency = nullptr);
+	void addError(const std::string& benchmark, const std::vector<std::pair<std::string, std::string>>& parameters, const std::string& message);
+
+private:
+	std::ostream& oStream;
+	std::string filter;
+
+	void printHeader(const std::string& benchmark, const std::vector<std::pair<std::string, std::string>>& parameters);
+	static std::string escape(const std::string& str);
+};
+
+} /* namespace bench */
+} /* namespace jboot */
+
+#endif /* JBOOT_BENCH_RESULT_H_ */
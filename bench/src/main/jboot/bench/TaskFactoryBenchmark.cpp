@@ -0,0 +1,114 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/bench/TaskFactoryBenchmark.h>
+#include <jboot/processing/procedure/Histogram.h>
+#include <jboot/processing/task/TaskFactory.h>
+
+#include <esl/object/Context.h>
+#include <esl/processing/Procedure.h>
+#include <esl/processing/Status.h>
+#include <esl/processing/TaskDescriptor.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+
+namespace jboot {
+namespace bench {
+
+namespace {
+const std::uint64_t tasksPerRun = 20000;
+
+class StartProbe : public esl::processing::Procedure {
+public:
+	StartProbe(processing::procedure::Histogram& aHistogram)
+	: histogram(aHistogram),
+	  submitTime(std::chrono::steady_clock::now())
+	{ }
+
+	void procedureRun(esl::object::Context&) override {
+		histogram.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - submitTime).count()));
+	}
+
+private:
+	processing::procedure::Histogram& histogram;
+	std::chrono::steady_clock::time_point submitTime;
+};
+
+void runThreads(Result& result, unsigned int threads) {
+	std::vector<std::pair<std::string, std::string>> parameters {
+		{ "threads", std::to_string(threads) },
+		{ "tasks", std::to_string(tasksPerRun) }
+	};
+
+	try {
+		processing::procedure::Histogram histogram;
+		std::mutex finishedMutex;
+		std::condition_variable finishedCV;
+		std::uint64_t finished = 0;
+
+		std::chrono::steady_clock::time_point startTime;
+		{
+			processing::task::TaskFactory taskFactory({{ "max-threads", std::to_string(threads) }});
+
+			startTime = std::chrono::steady_clock::now();
+			for(std::uint64_t i = 0; i < tasksPerRun; ++i) {
+				esl::processing::TaskDescriptor descriptor;
+				descriptor.procedure.reset(new StartProbe(histogram));
+				descriptor.onStateChanged = [&](esl::processing::Status status) {
+					if(status == esl::processing::Status::done || status == esl::processing::Status::exception || status == esl::processing::Status::canceled) {
+						std::lock_guard<std::mutex> lock(finishedMutex);
+						if(++finished == tasksPerRun) {
+							finishedCV.notify_all();
+						}
+					}
+				};
+				taskFactory.createTask(std::move(descriptor));
+			}
+
+			std::unique_lock<std::mutex> lock(finishedMutex);
+			finishedCV.wait(lock, [&]() {
+				return finished == tasksPerRun;
+			});
+		}
+		std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - startTime;
+
+		result.add("task-factory/submit-to-start", parameters, tasksPerRun, elapsed, &histogram);
+	}
+	catch(const std::exception& e) {
+		result.addError("task-factory/submit-to-start", parameters, e.what());
+	}
+}
+} /* anonymous namespace */
+
+void TaskFactoryBenchmark::run(Result& result) {
+	if(!result.isSelected("task-factory")) {
+		return;
+	}
+
+	for(unsigned int threads = 1; threads <= 64; threads *= 2) {
+		runThreads(result, threads);
+	}
+}
+
+} /* namespace bench */
+} /* namespace jboot */
@@ -0,0 +1,58 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/bench/BootContextBenchmark.h>
+#include <jboot/bench/ConfigContextBenchmark.h>
+#include <jboot/bench/LoggerBenchmark.h>
+#include <jboot/bench/ObjectContextBenchmark.h>
+#include <jboot/bench/Result.h>
+#include <jboot/bench/TaskFactoryBenchmark.h>
+#include <jboot/Plugin.h>
+
+#include <esl/plugin/Registry.h>
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+/* Usage: jboot-bench [<benchmark-prefix>]
+ * Writes one JSON object per line to stdout, e.g. "jboot-bench task-factory > bench_output.txt" */
+int main(int argc, const char* argv[]) {
+	if(argc > 2) {
+		std::cerr << "Usage: " << argv[0] << " [<benchmark-prefix>]\n";
+		std::cerr << "Benchmarks: task-factory, object-context, boot-context, config-context, logger\n";
+		return -1;
+	}
+
+	try {
+		jboot::Plugin::install(esl::plugin::Registry::get(), nullptr);
+	}
+	catch(const std::exception& e) {
+		std::cerr << "Installing jboot plugins failed: " << e.what() << "\n";
+	}
+
+	jboot::bench::Result result(std::cout, argc == 2 ? argv[1] : "");
+
+	jboot::bench::TaskFactoryBenchmark::run(result);
+	jboot::bench::ObjectContextBenchmark::run(result);
+	jboot::bench::BootContextBenchmark::run(result);
+	jboot::bench::ConfigContextBenchmark::run(result);
+	jboot::bench::LoggerBenchmark::run(result);
+
+	return 0;
+}
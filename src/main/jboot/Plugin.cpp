@@ -18,7 +18,13 @@
 
 #include <jboot/Plugin.h>
 #include <jboot/boot/context/Context.h>
+#include <jboot/boot/context/Pipeline.h>
+#include <jboot/boot/context/Prefork.h>
+#include <jboot/boot/context/Sharded.h>
 #include <jboot/boot/logging/Config.h>
+#include <jboot/processing/procedure/FanOut.h>
+#include <jboot/processing/procedure/LoadGenerator.h>
+#include <jboot/processing/task/ProcessTaskFactory.h>
 #include <jboot/processing/task/TaskFactory.h>
 
 #include <eslx/Plugin.h>
@@ -34,6 +40,7 @@
 #include <esl/logging/Appender.h>
 #include <esl/logging/Layout.h>
 #include <esl/plugin/Registry.h>
+#include <esl/processing/Procedure.h>
 #include <esl/processing/TaskFactory.h>
 #include <esl/system/Process.h>
 #include <esl/system/Signal.h>
@@ -64,6 +71,9 @@ void Plugin::install(esl::plugin::Registry& registry, const char* data) {
 	 * esl::boot *
 	 * ********* */
 	registry.addPlugin<esl::boot::context::Context>("jboot/boot/context/Context", &boot::context::Context::create);
+	registry.addPlugin<esl::boot::context::Context>("jboot/boot/context/Pipeline", &boot::context::Pipeline::create);
+	registry.addPlugin<esl::boot::context::Context>("jboot/boot/context/Prefork", &boot::context::Prefork::create);
+	registry.addPlugin<esl::boot::context::Context>("jboot/boot/context/Sharded", &boot::context::Sharded::create);
 	registry.addPlugin<esl::boot::logging::Config>("jboot/boot/logging/Config", &boot::logging::Config::create);
 
 	/* *************** *
@@ -89,6 +99,9 @@ void Plugin::install(esl::plugin::Registry& registry, const char* data) {
 	 * esl::processing *
 	 * *************** */
 	registry.addPlugin<esl::processing::TaskFactory>("jboot/processing/TaskFactory", &processing::task::TaskFactory::create);
+	registry.addPlugin<esl::processing::TaskFactory>("jboot/processing/ProcessTaskFactory", &processing::task::ProcessTaskFactory::create);
+	registry.addPlugin<esl::processing::Procedure>("jboot/processing/FanOut", &processing::procedure::FanOut::create);
+	registry.addPlugin<esl::processing::Procedure>("jboot/processing/LoadGenerator", &processing::procedure::LoadGenerator::create);
 
 	/* *********** *
 	 * esl::system *
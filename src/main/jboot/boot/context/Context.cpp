@@ -17,15 +17,31 @@
  */
 
 #include <jboot/boot/context/Context.h>
+#include <jboot/boot/context/Timeline.h>
 #include <jboot/config/context/Context.h>
+#include <jboot/object/Context.h>
+#include <jboot/object/Epoch.h>
+#include <jboot/object/Reusable.h>
+#include <jboot/processing/task/TaskFactory.h>
 #include <jboot/Logger.h>
 
 #include <esl/com/http/server/exception/StatusCode.h>
 #include <esl/database/exception/SqlError.h>
+#include <esl/processing/TaskDescriptor.h>
 #include <esl/utility/String.h>
 
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <set>
 #include <stdexcept>
+#include <streambuf>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
 namespace jboot {
 namespace boot {
@@ -34,24 +50,355 @@ namespace context {
 namespace {
 Logger logger("jboot::boot::context::Context");
 
+std::atomic<std::uint64_t> objectsGeneration { 1 };
+
+/* reused by every exception a thread shows, so showing an exception does not allocate once the buffer has grown */
+thread_local std::string exceptionBuffer;
+
+template<typename T>
+void appendNumber(std::string& buffer, T value) {
+	char digits[24];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+	buffer.append(digits, result.ptr);
+}
+
+void appendLevel(std::string& buffer, int level) {
+	buffer += '[';
+	appendNumber(buffer, level);
+	buffer += ']';
+}
+
+/* appends everything written to the stream to a string, so dumps are rendered without a copy */
+class AppendStreamBuf : public std::streambuf {
+public:
+	void setBuffer(std::string& aBuffer) {
+		buffer = &aBuffer;
+	}
+
+protected:
+	int_type overflow(int_type c) override {
+		if(!traits_type::eq_int_type(c, traits_type::eof())) {
+			buffer->push_back(traits_type::to_char_type(c));
+		}
+		return traits_type::not_eof(c);
+	}
+
+	std::streamsize xsputn(const char* data, std::streamsize size) override {
+		buffer->append(data, static_cast<std::size_t>(size));
+		return size;
+	}
+
+private:
+	std::string* buffer = nullptr;
+};
+
+/* for dump functions that write to a stream */
+std::ostream& getDumpStream(std::string& buffer) {
+	thread_local AppendStreamBuf streamBuf;
+	thread_local std::ostream oStream(&streamBuf);
+	streamBuf.setBuffer(buffer);
+	oStream.clear();
+	return oStream;
+}
+
 void addException(esl::object::Context& context, std::exception_ptr exceptionPtr) {
 	esl::object::Object* objectPtr = context.findObject<esl::object::Object>("exception");
 	esl::object::Value<std::exception_ptr>* exceptionObjectPtr = dynamic_cast<esl::object::Value<std::exception_ptr>*>(objectPtr);
 
 	if(exceptionObjectPtr) {
-		*exceptionObjectPtr = std::current_exception();
+		*exceptionObjectPtr = exceptionPtr;
 	}
 	else if(objectPtr == nullptr) {
-		context.addObject("exception", std::unique_ptr<esl::object::Value<std::exception_ptr>>(new esl::object::Value<std::exception_ptr>(std::current_exception())));
+		context.addObject("exception", std::unique_ptr<esl::object::Value<std::exception_ptr>>(new esl::object::Value<std::exception_ptr>(exceptionPtr)));
 	}
 }
+
+std::size_t toEntryIndex(const std::string& value) {
+	std::size_t index = 0;
+	try {
+		std::size_t pos = 0;
+		index = static_cast<std::size_t>(std::stoul(value, &pos));
+		if(pos != value.size()) {
+			index = 0;
+		}
+	}
+	catch(...) {
+	}
+	if(index == 0) {
+		throw std::runtime_error("Invalid entry number \"" + value + "\" for attribute 'entry-dependency'. Entries are numbered from 1.");
+	}
+	return index - 1;
+}
+
+/* Schedules the entries of a context for execution = parallel */
+class EntryScheduler {
+public:
+	EntryScheduler(esl::processing::TaskFactory& aTaskFactory, std::size_t entries, std::function<void(std::size_t)> aRunEntry, std::function<bool(std::exception_ptr)> aOnException)
+	: taskFactory(aTaskFactory),
+	  runEntry(std::move(aRunEntry)),
+	  onException(std::move(aOnException)),
+	  dependencies(entries, 0),
+	  dependents(entries)
+	{ }
+
+	void addDependency(std::size_t entry, std::size_t dependsOn) {
+		if(entry >= dependencies.size() || dependsOn >= dependencies.size()) {
+			throw std::runtime_error("Invalid definition of 'entry-dependency' = '" + std::to_string(entry+1) + ":" + std::to_string(dependsOn+1) + "'. Context has " + std::to_string(dependencies.size()) + " entries.");
+		}
+		++dependencies[entry];
+		dependents[dependsOn].push_back(entry);
+	}
+
+	/* runs all entries and returns the exception that stopped the execution */
+	std::exception_ptr run() {
+		checkCycles();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		for(std::size_t entry = 0; entry < dependencies.size(); ++entry) {
+			if(dependencies[entry] == 0) {
+				start(entry);
+			}
+		}
+
+		finishedCV.wait(lock, [this]() {
+			return running == 0;
+		});
+
+		return stopException;
+	}
+
+private:
+	class Procedure : public esl::processing::Procedure {
+	public:
+		Procedure(EntryScheduler& aScheduler, std::size_t aEntry)
+		: scheduler(aScheduler),
+		  entry(aEntry)
+		{ }
+
+		void procedureRun(esl::object::Context&) override {
+			std::exception_ptr exceptionPtr;
+			try {
+				scheduler.runEntry(entry);
+			}
+			catch(...) {
+				exceptionPtr = std::current_exception();
+			}
+			scheduler.finished(entry, exceptionPtr);
+		}
+
+		void procedureCancel() override {
+		}
+
+	private:
+		EntryScheduler& scheduler;
+		const std::size_t entry;
+	};
+
+	esl::processing::TaskFactory& taskFactory;
+	std::function<void(std::size_t)> runEntry;
+	std::function<bool(std::exception_ptr)> onException;
+
+	std::vector<std::size_t> dependencies;
+	std::vector<std::vector<std::size_t>> dependents;
+
+	std::mutex mutex;
+	std::condition_variable finishedCV;
+	std::size_t running = 0;
+	std::exception_ptr stopException;
+	std::vector<esl::processing::Task> tasks;
+
+	void checkCycles() const {
+		std::vector<std::size_t> remaining(dependencies);
+		std::vector<std::size_t> ready;
+		std::size_t visited = 0;
+
+		for(std::size_t entry = 0; entry < remaining.size(); ++entry) {
+			if(remaining[entry] == 0) {
+				ready.push_back(entry);
+			}
+		}
+		while(!ready.empty()) {
+			std::size_t entry = ready.back();
+			ready.pop_back();
+			++visited;
+			for(std::size_t dependent : dependents[entry]) {
+				if(--remaining[dependent] == 0) {
+					ready.push_back(dependent);
+				}
+			}
+		}
+
+		if(visited != remaining.size()) {
+			throw std::runtime_error("Definition of 'entry-dependency' contains a cycle.");
+		}
+	}
+
+	/* called with locked mutex */
+	void start(std::size_t entry) {
+		esl::processing::TaskDescriptor descriptor;
+		descriptor.procedure.reset(new Procedure(*this, entry));
+		++running;
+		try {
+			tasks.push_back(taskFactory.createTask(std::move(descriptor)));
+		}
+		catch(...) {
+			--running;
+			if(!stopException) {
+				stopException = std::current_exception();
+			}
+		}
+	}
+
+	void finished(std::size_t entry, std::exception_ptr exceptionPtr) {
+		/* called without lock, because it prints the exception */
+		bool stop = exceptionPtr && onException(exceptionPtr);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(stop && !stopException) {
+			stopException = exceptionPtr;
+		}
+		if(!stopException) {
+			for(std::size_t dependent : dependents[entry]) {
+				if(--dependencies[dependent] == 0) {
+					start(dependent);
+				}
+			}
+		}
+
+		if(--running == 0) {
+			finishedCV.notify_all();
+		}
+	}
+};
 } /* anonymous namespace */
 
+/* Records the objects that are looked up by the calling thread while an object is initialized.
+ * Recorders are stacked, because initializing an object might initialize other objects. */
+class Context::DependencyRecorder {
+public:
+	DependencyRecorder(Context& aContext, const esl::object::Object* aDependent)
+	: context(aContext.shutdown == parallelShutdown ? &aContext : nullptr),
+	  dependent(aDependent),
+	  previous(recorders)
+	{
+		if(context) {
+			recorders = this;
+		}
+	}
+
+	~DependencyRecorder() {
+		if(context) {
+			recorders = previous;
+		}
+	}
+
+	static void record(const esl::object::Object* object) {
+		if(recorders == nullptr || object == nullptr) {
+			return;
+		}
+
+		for(DependencyRecorder* recorder = recorders; recorder; recorder = recorder->previous) {
+			if(recorder->dependent != object) {
+				std::lock_guard<std::mutex> lock(recorder->context->dependenciesMutex);
+				recorder->context->dependencies.emplace_back(recorder->dependent, object);
+			}
+		}
+	}
+
+private:
+	static thread_local DependencyRecorder* recorders;
+
+	Context* context;
+	const esl::object::Object* dependent;
+	DependencyRecorder* previous;
+};
+
+thread_local Context::DependencyRecorder* Context::DependencyRecorder::recorders = nullptr;
+
 std::unique_ptr<esl::boot::context::Context> Context::create(const std::vector<std::pair<std::string, std::string>>& settings) {
 	return std::unique_ptr<esl::boot::context::Context>(new Context(settings));
 }
 
+class Context::ExceptionReporter {
+public:
+	ExceptionReporter(Context& aContext, std::size_t aCapacity)
+	: context(aContext),
+	  capacity(aCapacity),
+	  thread([this]() {
+		run();
+	  })
+	{ }
+
+	~ExceptionReporter() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+		}
+		notEmptyCV.notify_one();
+		thread.join();
+	}
+
+	void push(std::exception_ptr exceptionPointer, std::uint64_t suppressed, bool withStacktrace) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(queue.size() >= capacity) {
+				++dropped;
+				return;
+			}
+			queue.push_back(Report{exceptionPointer, suppressed, withStacktrace});
+		}
+		notEmptyCV.notify_one();
+	}
+
+private:
+	struct Report {
+		std::exception_ptr exceptionPointer;
+		std::uint64_t suppressed;
+		bool withStacktrace;
+	};
+
+	Context& context;
+	const std::size_t capacity;
+
+	std::mutex mutex;
+	std::condition_variable notEmptyCV;
+	std::deque<Report> queue;
+	std::uint64_t dropped = 0;
+	bool stopped = false;
+
+	/* last member, because the thread uses all other members */
+	std::thread thread;
+
+	/* queued exceptions are written before the thread stops */
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while(true) {
+			notEmptyCV.wait(lock, [this]() {
+				return stopped || !queue.empty();
+			});
+			if(queue.empty()) {
+				return;
+			}
+
+			Report report = std::move(queue.front());
+			queue.pop_front();
+			std::uint64_t droppedReports = dropped;
+			dropped = 0;
+
+			lock.unlock();
+			try {
+				context.writeException(report.exceptionPointer, report.suppressed, droppedReports, report.withStacktrace);
+			}
+			catch(...) {
+			}
+			lock.lock();
+		}
+	}
+};
+
 Context::Context(const std::vector<std::pair<std::string, std::string>>& settings) {
+	bool hasLazyObjects = false;
+
     for(const auto& setting : settings) {
 		if(setting.first == "handle-exception") {
 			if(hasHandleException) {
@@ -93,6 +440,228 @@ Context::Context(const std::vector<std::pair<std::string, std::string>>& setting
 		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'show-stacktrace'");
 			}
 		}
+		else if(setting.first == "execution") {
+			if(hasExecution) {
+		        throw std::runtime_error("multiple definition of attribute 'execution'.");
+			}
+			hasExecution = true;
+			if(setting.second == "sequential") {
+				execution = sequential;
+			}
+			else if(setting.second == "parallel") {
+				execution = parallel;
+			}
+			else {
+		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'execution'");
+			}
+		}
+		else if(setting.first == "task-factory-id") {
+			if(!taskFactoryId.empty()) {
+		        throw std::runtime_error("multiple definition of attribute 'task-factory-id'.");
+			}
+			taskFactoryId = setting.second;
+			if(taskFactoryId.empty()) {
+		    	throw std::runtime_error("Invalid value \"\" for attribute 'task-factory-id'");
+			}
+		}
+		else if(setting.first == "entry-dependency") {
+			/* "<entry>:<entry>,<entry>,..." - the first entry starts after the other entries have been finished */
+			std::string::size_type colonPos = setting.second.find(':');
+			if(colonPos == std::string::npos) {
+		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'entry-dependency'. Value must be '<entry>:<entry>,<entry>,...'");
+			}
+
+			std::pair<std::size_t, std::vector<std::size_t>> entryDependency;
+			entryDependency.first = toEntryIndex(setting.second.substr(0, colonPos));
+			for(std::string::size_type pos = colonPos + 1; pos <= setting.second.size();) {
+				std::string::size_type commaPos = std::min(setting.second.find(',', pos), setting.second.size());
+				entryDependency.second.push_back(toEntryIndex(setting.second.substr(pos, commaPos - pos)));
+				pos = commaPos + 1;
+			}
+			entryDependencies.push_back(std::move(entryDependency));
+		}
+		else if(setting.first == "lazy-objects") {
+			if(hasLazyObjects) {
+		        throw std::runtime_error("multiple definition of attribute 'lazy-objects'.");
+			}
+			std::string value = esl::utility::String::toLower(setting.second);
+			hasLazyObjects = true;
+			if(value == "true") {
+				lazyObjects = true;
+			}
+			else if(value == "false") {
+				lazyObjects = false;
+			}
+			else {
+		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'lazy-objects'");
+			}
+		}
+		else if(setting.first == "install-threads") {
+			if(installThreads > 0) {
+		        throw std::runtime_error("multiple definition of attribute 'install-threads'.");
+			}
+
+			long tmpInstallThreads;
+			try {
+				tmpInstallThreads = std::stol(setting.second);
+			}
+			catch(...) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'install-threads'.");
+			}
+
+			if(tmpInstallThreads <= 0 || tmpInstallThreads > 1000) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'install-threads'. Value has to be between 1 and 1000.");
+			}
+			installThreads = static_cast<unsigned int>(tmpInstallThreads);
+		}
+		else if(setting.first == "timeline-output") {
+			if(timelineOutput) {
+		        throw std::runtime_error("multiple definition of attribute 'timeline-output'.");
+			}
+
+			if(setting.second == "stdout") {
+				timelineOutput.reset(new ShowOutput(std::cout));
+			}
+			else if(setting.second == "stderr") {
+				timelineOutput.reset(new ShowOutput(std::cerr));
+			}
+			else if(setting.second == "trace") {
+				timelineOutput.reset(new ShowOutput(logger.trace));
+			}
+			else if(setting.second == "debug") {
+				timelineOutput.reset(new ShowOutput(logger.debug));
+			}
+			else if(setting.second == "info") {
+				timelineOutput.reset(new ShowOutput(logger.info));
+			}
+			else if(setting.second == "warn") {
+				timelineOutput.reset(new ShowOutput(logger.warn));
+			}
+			else if(setting.second == "error") {
+				timelineOutput.reset(new ShowOutput(logger.error));
+			}
+			else {
+		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'timeline-output'");
+			}
+			Timeline::enable();
+		}
+		else if(setting.first == "timeline-file") {
+			if(!timelineFile.empty()) {
+		        throw std::runtime_error("multiple definition of attribute 'timeline-file'.");
+			}
+			timelineFile = setting.second;
+			if(timelineFile.empty()) {
+		    	throw std::runtime_error("Invalid value \"\" for attribute 'timeline-file'");
+			}
+			Timeline::enable();
+		}
+		else if(setting.first == "warmup-procedure") {
+			if(setting.second.empty()) {
+		    	throw std::runtime_error("Invalid value \"\" for attribute 'warmup-procedure'");
+			}
+			warmupProcedureIds.push_back(setting.second);
+		}
+		else if(setting.first == "warmup-timeout-ms") {
+			if(hasWarmupTimeout) {
+		        throw std::runtime_error("multiple definition of attribute 'warmup-timeout-ms'.");
+			}
+			hasWarmupTimeout = true;
+
+			long ms;
+			try {
+				ms = std::stol(setting.second);
+			}
+			catch(...) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'warmup-timeout-ms'.");
+			}
+			if(ms <= 0) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'warmup-timeout-ms'. Value has to be greater than 0.");
+			}
+			warmupTimeout = std::chrono::milliseconds(ms);
+		}
+		else if(setting.first == "shutdown") {
+			if(hasShutdown) {
+		        throw std::runtime_error("multiple definition of attribute 'shutdown'.");
+			}
+			hasShutdown = true;
+			if(setting.second == "sequential") {
+				shutdown = sequentialShutdown;
+			}
+			else if(setting.second == "parallel") {
+				shutdown = parallelShutdown;
+			}
+			else {
+		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'shutdown'");
+			}
+		}
+		else if(setting.first == "shutdown-timeout-ms") {
+			if(hasShutdownTimeout) {
+		        throw std::runtime_error("multiple definition of attribute 'shutdown-timeout-ms'.");
+			}
+			hasShutdownTimeout = true;
+
+			long ms;
+			try {
+				ms = std::stol(setting.second);
+			}
+			catch(...) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'shutdown-timeout-ms'.");
+			}
+			if(ms <= 0) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'shutdown-timeout-ms'. Value has to be greater than 0.");
+			}
+			shutdownTimeout = std::chrono::milliseconds(ms);
+		}
+		else if(setting.first == "exception-rate-limit" || setting.first == "stacktrace-sample") {
+			unsigned int& value = setting.first == "exception-rate-limit" ? exceptionRateLimit : stacktraceSample;
+			if(value > 0) {
+		        throw std::runtime_error("multiple definition of attribute '" + setting.first + "'.");
+			}
+
+			long tmpValue;
+			try {
+				tmpValue = std::stol(setting.second);
+			}
+			catch(...) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute '" + setting.first + "'.");
+			}
+			if(tmpValue <= 0 || tmpValue > 1000000) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute '" + setting.first + "'. Value has to be between 1 and 1000000.");
+			}
+			value = static_cast<unsigned int>(tmpValue);
+		}
+		else if(setting.first == "exception-reporting") {
+			if(hasExceptionReporting) {
+		        throw std::runtime_error("multiple definition of attribute 'exception-reporting'.");
+			}
+			hasExceptionReporting = true;
+			if(setting.second == "synchronous") {
+				asynchronousExceptions = false;
+			}
+			else if(setting.second == "asynchronous") {
+				asynchronousExceptions = true;
+			}
+			else {
+		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'exception-reporting'");
+			}
+		}
+		else if(setting.first == "exception-queue-size") {
+			if(exceptionQueueSize > 0) {
+		        throw std::runtime_error("multiple definition of attribute 'exception-queue-size'.");
+			}
+
+			long tmpQueueSize;
+			try {
+				tmpQueueSize = std::stol(setting.second);
+			}
+			catch(...) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'exception-queue-size'.");
+			}
+			if(tmpQueueSize <= 0) {
+	            throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'exception-queue-size'. Value has to be greater than 0.");
+			}
+			exceptionQueueSize = static_cast<std::size_t>(tmpQueueSize);
+		}
 		else if(setting.first == "show-output") {
 			if(showOutput) {
 		        throw std::runtime_error("multiple definition of attribute 'show-output'.");
@@ -137,70 +706,499 @@ Context::Context(const std::vector<std::pair<std::string, std::string>>& setting
 	if(showOutput && handleException != stopAndShow && handleException != ignoreAndShow) {
 		logger.warn << "Definition of 'show-output' is useless if definition of 'handle-exception' is neither 'stop-and-show' nor 'ignore-and-show'";
 	}
+	if((exceptionRateLimit > 0 || stacktraceSample > 0) && handleException != stopAndShow && handleException != ignoreAndShow) {
+		logger.warn << "Definition of 'exception-rate-limit' or 'stacktrace-sample' is useless if definition of 'handle-exception' is neither 'stop-and-show' nor 'ignore-and-show'";
+	}
+	if((asynchronousExceptions || exceptionQueueSize > 0) && handleException != stopAndShow && handleException != ignoreAndShow) {
+		logger.warn << "Definition of 'exception-reporting' or 'exception-queue-size' is useless if definition of 'handle-exception' is neither 'stop-and-show' nor 'ignore-and-show'";
+	}
+	if(exceptionQueueSize > 0 && !asynchronousExceptions) {
+		logger.warn << "Definition of 'exception-queue-size' is useless if definition of 'exception-reporting' is not 'asynchronous'";
+	}
+	if(exceptionQueueSize == 0) {
+		exceptionQueueSize = 1024;
+	}
 	if(hasShowStacktrace && showStacktrace && handleException != stopAndShow && handleException != ignoreAndShow) {
 		logger.warn << "Definition of 'show-stacktrace' is useless if definition of 'handle-exception' is neither 'stop-and-show' nor 'ignore-and-show'";
 	}
+	if(execution != parallel && !taskFactoryId.empty()) {
+		logger.warn << "Definition of 'task-factory-id' is useless if definition of 'execution' is not 'parallel'";
+	}
+	if(execution != parallel && !entryDependencies.empty()) {
+		logger.warn << "Definition of 'entry-dependency' is useless if definition of 'execution' is not 'parallel'";
+	}
+	if(hasWarmupTimeout && warmupProcedureIds.empty()) {
+		logger.warn << "Definition of 'warmup-timeout-ms' is useless without definition of 'warmup-procedure'";
+	}
+	if(hasShutdownTimeout && shutdown != parallelShutdown && !hasWarmupTimeout) {
+		logger.warn << "Definition of 'shutdown-timeout-ms' is useless if definition of 'shutdown' is not 'parallel' and 'warmup-timeout-ms' is not defined";
+	}
 }
 
-void Context::setParent(Context* parentContext) {
-	parent = parentContext;
+struct Context::WarmupProgress {
+	WarmupProgress(std::size_t size)
+	: finished(size, false)
+	{ }
 
-	if(!hasHandleException) {
-		handleException = parent ? rethrow : showOutput ? stopAndShow : stop;
-	}
-}
+	std::mutex mutex;
+	std::condition_variable finishedCV;
+	std::vector<bool> finished;
+	std::size_t finishedCount = 0;
+};
 
-esl::boot::context::Context& Context::addData(const std::string& configuration) {
-	config::context::Context config(configuration);
+Context::~Context() {
+	/* writes the exceptions that are still queued */
+	exceptionReporter.reset();
 
-	config.loadLibraries();
-	config.install(*this);
+	cancelAfterInitialize(this);
 
-	return *this;
+	/* Warmup procedures that exceeded their time budget are still using objects of this context.
+	 * They are waited for until 'shutdown-timeout-ms' or 'warmup-timeout-ms' has passed once more.
+	 * Afterwards the objects of the state they have been started with are destroyed by the last of them. */
+	if(warmupProgress) {
+		std::unique_lock<std::mutex> lock(warmupProgress->mutex);
+		auto isFinished = [this]() {
+			return warmupProgress->finishedCount == warmupProgress->finished.size();
+		};
+		if(!isFinished()) {
+			std::chrono::milliseconds timeout = hasShutdownTimeout ? shutdownTimeout : warmupTimeout;
+			logger.warn << "Waiting up to " << timeout.count() << " ms for " << (warmupProgress->finished.size() - warmupProgress->finishedCount) << " warmup procedures before the context is destroyed.\n";
+			if(!warmupProgress->finishedCV.wait_for(lock, timeout, isFinished)) {
+				logger.error << "Warmup procedures are still running. Their objects are destroyed when they have finished.\n";
+			}
+		}
+	}
+
+	/* nobody can look at the states of a context that is destroyed */
+	object::Epoch::releaseAll(this);
+
+	if(shutdown == parallelShutdown) {
+		shutdownParallel();
+	}
 }
 
-esl::boot::context::Context& Context::addFile(const boost::filesystem::path& filename) {
-	config::context::Context config(filename);
+void Context::shutdownParallel() {
+	struct Node {
+		Node(std::string aName, std::unique_ptr<esl::object::Object> aObject)
+		: name(std::move(aName)),
+		  object(std::move(aObject))
+		{ }
 
-	config.loadLibraries();
-	config.install(*this);
+		std::string name;
+		std::unique_ptr<esl::object::Object> object;
+		/* nodes that have to be destroyed after this node */
+		std::vector<std::size_t> dependencies;
+		/* number of nodes that have to be destroyed before this node */
+		std::size_t dependents = 0;
+		bool queued = false;
+		bool started = false;
+		bool done = false;
+	};
 
-	return *this;
-}
+	/* shared with the threads, because they are detached if the deadline is exceeded */
+	struct Teardown {
+		std::mutex mutex;
+		std::condition_variable changedCV;
+		std::vector<Node> nodes;
+		std::deque<std::size_t> ready;
+		std::size_t running = 0;
+		std::size_t finished = 0;
+		bool stopped = false;
+	};
+	std::shared_ptr<Teardown> teardown(new Teardown);
 
-esl::boot::context::Context& Context::addReference(const std::string& destinationId, const std::string& sourceId) {
-	esl::object::Object* object = findRawObject(sourceId);
+	std::unordered_map<const esl::object::Object*, std::size_t> nodeIndexes;
+	for(std::size_t index = 0; index < state->entries.size(); ++index) {
+		std::unique_ptr<esl::object::Object> object = state->entries[index]->releaseObject();
+		if(object) {
+			nodeIndexes[object.get()] = teardown->nodes.size();
+			teardown->nodes.push_back(Node{"entry #" + std::to_string(index + 1), std::move(object)});
+		}
+	}
+	for(auto& object : state->objects) {
+		if(object.second->object) {
+			object.second->refObject.store(nullptr);
+			nodeIndexes[object.second->object.get()] = teardown->nodes.size();
+			teardown->nodes.push_back(Node{object.first.getName(), std::move(object.second->object)});
+		}
+	}
 
-	if(object == nullptr) {
-        throw std::runtime_error("Cannot add reference with id '" + destinationId + "' because source object with id '" + sourceId + "' does not exists.");
+	std::vector<Node>& nodes = teardown->nodes;
+	if(nodes.empty()) {
+		return;
 	}
 
-	if(destinationId.empty()) {
-		entries.push_back(std::unique_ptr<Entry>(new Entry(*object)));
+	std::set<std::pair<std::size_t, std::size_t>> edges;
+	{
+		std::lock_guard<std::mutex> lock(dependenciesMutex);
+		for(const auto& dependency : dependencies) {
+			auto dependent = nodeIndexes.find(dependency.first);
+			auto object = nodeIndexes.find(dependency.second);
+			if(dependent != nodeIndexes.end() && object != nodeIndexes.end() && dependent->second != object->second) {
+				edges.emplace(dependent->second, object->second);
+			}
+		}
 	}
-	else {
-		if(objects.count(destinationId) == 0) {
-	        throw std::runtime_error("Cannot add reference with id '" + destinationId + "' because there exists already an object with same id.");
+	for(const auto& edge : edges) {
+		nodes[edge.first].dependencies.push_back(edge.second);
+		++nodes[edge.second].dependents;
+	}
+	for(std::size_t index = 0; index < nodes.size(); ++index) {
+		if(nodes[index].dependents == 0) {
+			nodes[index].queued = true;
+			teardown->ready.push_back(index);
 		}
-		objects.insert(std::make_pair(destinationId, IdElement(*object)));
 	}
 
-	return *this;
-}
+	const std::size_t threadCount = std::min<std::size_t>(nodes.size(), std::max(8u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> threads;
+	for(std::size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([teardown]() {
+			std::unique_lock<std::mutex> lock(teardown->mutex);
+			while(true) {
+				teardown->changedCV.wait(lock, [&teardown]() {
+					return teardown->stopped || !teardown->ready.empty() || teardown->finished == teardown->nodes.size();
+				});
+				if(teardown->stopped || teardown->ready.empty()) {
+					return;
+				}
 
-int Context::getReturnCode() const {
-	return returnCode;
-}
+				Node& node = teardown->nodes[teardown->ready.front()];
+				teardown->ready.pop_front();
+				node.started = true;
+				++teardown->running;
 
-void Context::onEvent(const esl::object::Object& object) {
-	initializeContext(*this);
+				lock.unlock();
+				try {
+					node.object.reset();
+				}
+				catch(...) {
+					logger.warn << "Exception while destroying object \"" << node.name << "\".\n";
+				}
+				lock.lock();
 
-#if 1
-	for(auto& entry : entries) {
+				node.done = true;
+				--teardown->running;
+				++teardown->finished;
+				for(std::size_t dependency : node.dependencies) {
+					Node& dependencyNode = teardown->nodes[dependency];
+					if(--dependencyNode.dependents == 0 && !dependencyNode.queued) {
+						dependencyNode.queued = true;
+						teardown->ready.push_back(dependency);
+					}
+				}
+				teardown->changedCV.notify_all();
+			}
+		});
+	}
+
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + shutdownTimeout;
+	bool exceeded = false;
+	{
+		std::unique_lock<std::mutex> lock(teardown->mutex);
+		while(teardown->finished < nodes.size()) {
+			auto isBlocked = [&teardown]() {
+				return teardown->finished == teardown->nodes.size() || (teardown->ready.empty() && teardown->running == 0);
+			};
+			if(!hasShutdownTimeout) {
+				teardown->changedCV.wait(lock, isBlocked);
+			}
+			else if(!teardown->changedCV.wait_until(lock, deadline, isBlocked)) {
+				exceeded = true;
+				break;
+			}
+
+			/* Cyclic dependencies: the most recently added object is destroyed first, like members are */
+			if(teardown->finished < nodes.size()) {
+				for(std::size_t index = nodes.size(); index > 0; --index) {
+					if(!nodes[index - 1].queued) {
+						nodes[index - 1].queued = true;
+						logger.warn << "Cyclic dependency between objects to destroy. Destroying \"" << nodes[index - 1].name << "\" first.\n";
+						teardown->ready.push_back(index - 1);
+						teardown->changedCV.notify_all();
+						break;
+					}
+				}
+			}
+		}
+
+		if(exceeded) {
+			teardown->stopped = true;
+			teardown->changedCV.notify_all();
+
+			for(auto& node : nodes) {
+				if(node.started && !node.done) {
+					logger.error << "Shutdown deadline of " << shutdownTimeout.count() << " ms exceeded while destroying object \"" << node.name << "\".\n";
+				}
+				else if(!node.started) {
+					logger.error << "Shutdown deadline of " << shutdownTimeout.count() << " ms exceeded. Object \"" << node.name << "\" is not destroyed.\n";
+					node.object.release();
+				}
+			}
+		}
+	}
+
+	for(auto& thread : threads) {
+		if(exceeded) {
+			thread.detach();
+		}
+		else {
+			thread.join();
+		}
+	}
+}
+
+void Context::setParent(Context* parentContext) {
+	parent = parentContext;
+	objectsGeneration.fetch_add(1);
+
+	if(!hasHandleException) {
+		handleException = parent ? rethrow : showOutput ? stopAndShow : stop;
+	}
+}
+
+esl::boot::context::Context& Context::addData(const std::string& configuration) {
+	Timeline::Step step("add-data");
+
+	std::unique_ptr<config::context::Context> config;
+	{
+		Timeline::Step parseStep("parse");
+		config.reset(new config::context::Context(configuration));
+	}
+
+	config->loadLibraries();
+
+	{
+		Timeline::Step installStep("install");
+		updateState(nullptr, [this, &config](State&) {
+			config->install(*this);
+		});
+	}
+
+	addSource(false, boost::filesystem::path(), configuration, *config);
+
+	return *this;
+}
+
+esl::boot::context::Context& Context::addFile(const boost::filesystem::path& filename) {
+	Timeline::Step step("add-file", filename.generic_string());
+
+	std::unique_ptr<config::context::Context> config;
+	{
+		Timeline::Step parseStep("parse", filename.generic_string());
+		config.reset(new config::context::Context(filename));
+	}
+
+	config->loadLibraries();
+
+	{
+		Timeline::Step installStep("install", filename.generic_string());
+		updateState(nullptr, [this, &config](State&) {
+			config->install(*this);
+		});
+	}
+
+	addSource(true, filename, std::string(), *config);
+
+	return *this;
+}
+
+void Context::reload() {
+	Timeline::Step step("reload");
+
+	std::unique_ptr<InitializeLock> lock(new InitializeLock(*this));
+	if(initializing || getUpdate()) {
+        throw std::runtime_error("Cannot reload context while it is initializing or updating.");
+	}
+
+	std::vector<std::unique_ptr<config::context::Context>> configs;
+	std::vector<std::string> savedConfigs;
+	bool changed = false;
+	for(const auto& source : sources) {
+		Timeline::Step parseStep("parse", source.isFile ? source.file.generic_string() : std::string());
+		if(source.isFile) {
+			configs.emplace_back(new config::context::Context(source.file));
+		}
+		else {
+			configs.emplace_back(new config::context::Context(source.data));
+		}
+
+		std::ostringstream savedConfig;
+		configs.back()->save(savedConfig);
+		savedConfigs.push_back(savedConfig.str());
+		changed = changed || savedConfigs.back() != source.savedConfig;
+	}
+
+	if(!changed) {
+		logger.info << "Reload: configuration has not been changed.\n";
+		return;
+	}
+
+	std::shared_ptr<State> oldState = state;
+	Reload reload;
+
+	updateState(&reload, [this, &oldState, &reload, &configs](State& newState) {
+		/* Entries and objects that have not been added by the configuration are kept.
+		 * They come before the entries and objects of the configuration. */
+		for(std::size_t index = 0; index < oldState->entries.size(); ++index) {
+			const std::string& signature = oldState->entrySignatures[index];
+			if(signature.empty()) {
+				newState.entries.push_back(oldState->entries[index]);
+				newState.entrySignatures.push_back(signature);
+			}
+			else if(oldState->entries[index]->isReusable()) {
+				reload.reusables.emplace(signature, Reusable{object::Symbol(), nullptr, oldState->entries[index]});
+			}
+		}
+		for(const auto& object : oldState->objects) {
+			const IdElement& idElement = *object.second;
+			if(idElement.signature.empty()) {
+				newState.objects.emplace(object.first, object.second);
+			}
+			/* References are always added again, because the referenced object might be created again.
+			 * A lazy object that has not been created yet is taken over even if it implements InitializeContext. */
+			else if(idElement.object ? dynamic_cast<esl::object::InitializeContext*>(idElement.object.get()) == nullptr || dynamic_cast<object::Reusable*>(idElement.object.get()) != nullptr : static_cast<bool>(idElement.create)) {
+				reload.reusables.emplace(idElement.signature, Reusable{object.first, object.second, nullptr});
+			}
+		}
+
+		for(auto& config : configs) {
+			config->loadLibraries();
+
+			Timeline::Step installStep("install");
+			config->installEntries(*this);
+		}
+
+		/* The new state is initialized before it gets published, so running calls don't wait for it */
+		if(oldState->initialized.load()) {
+			initializing = true;
+			try {
+				initializeState(newState);
+			}
+			catch(...) {
+				initializing = false;
+				throw;
+			}
+			initializing = false;
+			newState.initialized.store(true);
+		}
+	});
+
+	for(std::size_t index = 0; index < sources.size(); ++index) {
+		sources[index].savedConfig = std::move(savedConfigs[index]);
+	}
+
+	logger.info << "Reload: " << reload.reused << " entries taken over, " << reload.installed << " entries installed.\n";
+
+	/* objects that have been created again are allowed to finish their initialization now */
+	lock.reset();
+	runPendingAfterInitialize();
+}
+
+Context::Install::Install(Context& aContext, const std::string& signature)
+: context(aContext)
+{
+	Update* update = context.getUpdate();
+	if(update && update->reload) {
+		Reload& reload = *update->reload;
+		auto iter = reload.reusables.find(signature);
+		if(iter == reload.reusables.end()) {
+			++reload.installed;
+		}
+		else {
+			if(iter->second.entry) {
+				update->state->entries.push_back(iter->second.entry);
+				update->state->entrySignatures.push_back(signature);
+			}
+			else if(update->state->objects.emplace(iter->second.id, iter->second.idElement) == nullptr) {
+		        throw std::runtime_error("Cannot add object with id '" + iter->second.id.getName() + "' because there exists already an object with same id.");
+			}
+
+			reload.reusables.erase(iter);
+			++reload.reused;
+			reused = true;
+			return;
+		}
+	}
+
+	context.installSignature = signature;
+}
+
+Context::Install::~Install() {
+	context.installSignature.clear();
+}
+
+bool Context::Install::isReused() const noexcept {
+	return reused;
+}
+
+bool Context::isReused(const std::string& signature) const {
+	/* called by threads creating objects in parallel, reusables are not modified meanwhile */
+	Update* currentUpdate = update.load(std::memory_order_acquire);
+	return currentUpdate && currentUpdate->reload && currentUpdate->reload->reusables.count(signature) > 0;
+}
+
+esl::boot::context::Context& Context::addReference(const std::string& destinationId, const std::string& sourceId) {
+	esl::object::Object* object = findRawObject(sourceId);
+
+	if(object == nullptr) {
+        throw std::runtime_error("Cannot add reference with id '" + destinationId + "' because source object with id '" + sourceId + "' does not exists.");
+	}
+
+	updateState(nullptr, [this, &destinationId, object](State& newState) {
+		if(destinationId.empty()) {
+			newState.entries.push_back(std::shared_ptr<Entry>(new Entry(*object)));
+			newState.entrySignatures.push_back(installSignature);
+		}
+		else {
+			std::shared_ptr<IdElement> idElement(new IdElement(*object));
+			idElement->signature = installSignature;
+			if(newState.objects.emplace(object::Symbol::intern(destinationId), std::move(idElement)) == nullptr) {
+		        throw std::runtime_error("Cannot add reference with id '" + destinationId + "' because there exists already an object with same id.");
+			}
+		}
+	});
+
+	return *this;
+}
+
+int Context::getReturnCode() const {
+	return returnCode;
+}
+
+void Context::addLazyObject(const std::string& id, std::function<std::unique_ptr<esl::object::Object>()> create) {
+	if(id.empty()) {
+        throw std::runtime_error("Cannot add lazy object without id.");
+	}
+
+	updateState(nullptr, [this, &id, &create](State& newState) {
+		std::shared_ptr<IdElement> idElement(new IdElement(std::move(create)));
+		idElement->signature = installSignature;
+		if(newState.objects.emplace(object::Symbol::intern(id), std::move(idElement)) == nullptr) {
+	        throw std::runtime_error("Cannot add object with id '" + id + "' because there exists already an object with same id.");
+		}
+	});
+}
+
+bool Context::getLazyObjects() const noexcept {
+	return lazyObjects;
+}
+
+unsigned int Context::getInstallThreads() const noexcept {
+	return installThreads == 0 ? 1 : installThreads;
+}
+
+void Context::onEvent(const esl::object::Object& object) {
+	std::shared_ptr<State> currentState = getState();
+	Pin pin(*this, *currentState);
+	initialize(*currentState);
+
+#if 1
+	for(auto entry : getEventRoute(*currentState, typeid(object))) {
 		entry->onEvent(object);
 	}
 #else
-	for(auto& entry : entries) {
+	for(auto& entry : getState()->entries) {
 		if(handleException == rethrow) {
 			entry->onEvent(object);
 		}
@@ -209,17 +1207,7 @@ void Context::onEvent(const esl::object::Object& object) {
 				entry->onEvent(object);
 			}
 			catch(...) {
-				if(showOutput && (handleException == stopAndShow || handleException == ignoreAndShow)) {
-					if(showOutput->ostream) {
-						printException(*showOutput->ostream, std::current_exception());
-					}
-					else if(showOutput->streamReal) {
-						printException(*showOutput->streamReal, std::current_exception(), esl::logging::Location{});
-					}
-					else if(showOutput->streamEmpty) {
-						printException(*showOutput->streamEmpty, std::current_exception(), esl::logging::Location{});
-					}
-				}
+				showException(std::current_exception());
 
 				if(handleException == stop || handleException == stopAndShow) {
 					break;
@@ -230,20 +1218,71 @@ void Context::onEvent(const esl::object::Object& object) {
 #endif
 }
 
+void Context::onEvents(const esl::object::Object* const* objects, std::size_t count) {
+	std::shared_ptr<State> currentState = getState();
+	Pin pin(*this, *currentState);
+	initialize(*currentState);
+
+	/* Batches are split into runs of objects of the same type, so every entry gets the objects
+	 * it is subscribed to in the original order. Usually a batch contains only one type. */
+	std::size_t begin = 0;
+	while(begin < count) {
+		const std::type_info& type = typeid(*objects[begin]);
+
+		std::size_t end = begin + 1;
+		while(end < count && typeid(*objects[end]) == type) {
+			++end;
+		}
+
+		for(auto entry : getEventRoute(*currentState, type)) {
+			entry->onEvents(objects + begin, end - begin);
+		}
+
+		begin = end;
+	}
+}
+
+const std::vector<Entry*>& Context::getEventRoute(State& currentState, const std::type_info& type) {
+	{
+		std::shared_lock<std::shared_mutex> lock(currentState.eventRoutesMutex);
+		auto iter = currentState.eventRoutes.find(std::type_index(type));
+		if(iter != currentState.eventRoutes.end()) {
+			return iter->second;
+		}
+	}
+
+	std::vector<Entry*> route;
+	for(auto entry : currentState.eventEntries) {
+		if(entry->isSubscribed(type)) {
+			route.push_back(entry);
+		}
+	}
+
+	/* values of an unordered_map keep their address on rehash */
+	std::unique_lock<std::shared_mutex> lock(currentState.eventRoutesMutex);
+	return currentState.eventRoutes.emplace(std::type_index(type), std::move(route)).first->second;
+}
+
 std::set<std::string> Context::getObjectIds() const {
 	std::set<std::string> rv;
 
-	for(const auto& object : objects) {
-		rv.insert(object.first);
+	for(const auto& object : getState()->objects) {
+		rv.insert(object.first.getName());
 	}
 
 	return rv;
 }
 
 void Context::procedureRun(esl::object::Context& context) {
-	initializeContext(*this);
+	/* keeps the objects alive if the context gets reloaded while running */
+	std::shared_ptr<State> currentState = getState();
+	Pin pin(*this, *currentState);
+	initialize(*currentState);
 
-	for(auto& entry : entries) {
+	if(execution == parallel) {
+		procedureRunParallel(context, *currentState);
+	}
+	else for(auto& entry : currentState->entries) {
 		if(handleException == rethrow) {
 			entry->procedureRun(context);
 		}
@@ -252,19 +1291,7 @@ void Context::procedureRun(esl::object::Context& context) {
 				entry->procedureRun(context);
 			}
 			catch(...) {
-				if(showOutput && (handleException == stopAndShow || handleException == ignoreAndShow)) {
-					if(showOutput->ostream) {
-						Logger::flush(*showOutput->ostream);
-						printException(*showOutput->ostream, std::current_exception());
-					}
-					else if(showOutput->streamReal) {
-						Logger::flush(*showOutput->streamReal);
-						printException(*showOutput->streamReal, std::current_exception(), esl::logging::Location{});
-					}
-					else if(showOutput->streamEmpty) {
-//						printException(*showOutput->streamEmpty, std::current_exception(), esl::logging::Location{});
-					}
-				}
+				showException(std::current_exception());
 
 				if(handleException == stop || handleException == stopAndShow) {
 					addException(context, std::current_exception());
@@ -280,190 +1307,831 @@ void Context::procedureRun(esl::object::Context& context) {
 	}
 }
 
-void Context::initializeContext(esl::object::Context&) {
-	for(auto& entry : entries) {
-		entry->initializeContext(*this);
+Context::Call::Call(Context& context)
+: owner(context),
+  state(context.getState())
+{
+	owner.initialize(*state);
+}
+
+std::size_t Context::Call::getEntryCount() const noexcept {
+	return state->entries.size();
+}
+
+void Context::Call::procedureRun(std::size_t index, esl::object::Context& context) const {
+	Pin pin(owner, *state);
+	state->entries[index]->procedureRun(context);
+}
+
+bool Context::onEntryException(esl::object::Context& context, std::exception_ptr exceptionPtr) {
+	if(handleException == rethrow) {
+		std::rethrow_exception(exceptionPtr);
 	}
-	for(auto& object : objects) {
-		if(object.second.initializeContext) {
-			object.second.initializeContext->initializeContext(*this);
-			object.second.initializeContext = nullptr;
-		}
+
+	showException(exceptionPtr);
+
+	if(handleException == stop || handleException == stopAndShow) {
+		addException(context, exceptionPtr);
+		return true;
 	}
+	return false;
 }
 
-esl::object::Object* Context::findRawObject(const std::string& id) {
-	auto iter = objects.find(id);
-	esl::object::Object* object = iter == std::end(objects) ? nullptr : &iter->second.refObject;
-	if(object) {
-		return object;
+void Context::procedureRunParallel(esl::object::Context& context, State& currentState) {
+	esl::processing::TaskFactory* taskFactoryPtr = taskFactory.get();
+	if(!taskFactoryId.empty()) {
+		taskFactoryPtr = findObject<esl::processing::TaskFactory>(taskFactoryId);
+		if(taskFactoryPtr == nullptr) {
+	        throw std::runtime_error("Cannot find task factory with id '" + taskFactoryId + "'.");
+		}
 	}
-	if(parent) {
-		parent->findObject<esl::object::Object>(id);
+
+	/* Entries share the context given to procedureRun, so procedures running in parallel
+	 * must not modify objects of this context without synchronization. */
+	EntryScheduler entryScheduler(*taskFactoryPtr, currentState.entries.size(),
+		[this, &currentState, &context](std::size_t entry) {
+			Pin pin(*this, currentState);
+			currentState.entries[entry]->procedureRun(context);
+		},
+		[this](std::exception_ptr exceptionPtr) {
+			if(handleException != rethrow) {
+				showException(exceptionPtr);
+			}
+			return handleException == rethrow || handleException == stop || handleException == stopAndShow;
+		});
+
+	for(const auto& entryDependency : entryDependencies) {
+		for(std::size_t dependsOn : entryDependency.second) {
+			entryScheduler.addDependency(entryDependency.first, dependsOn);
+		}
+	}
+
+	/* After an exception with handle-exception = stop or rethrow no further entries are started,
+	 * but entries that are already running are not canceled. */
+	std::exception_ptr exceptionPtr = entryScheduler.run();
+	if(exceptionPtr) {
+		if(handleException == rethrow) {
+			std::rethrow_exception(exceptionPtr);
+		}
+		addException(context, exceptionPtr);
 	}
-	return nullptr;
 }
 
-const esl::object::Object* Context::findRawObject(const std::string& id) const {
-	auto iter = objects.find(id);
-	esl::object::Object* object = iter == std::end(objects) ? nullptr : &iter->second.refObject;
-	if(object) {
-		return object;
+void Context::showException(std::exception_ptr exceptionPointer) {
+	if(!showOutput || (handleException != stopAndShow && handleException != ignoreAndShow)) {
+		return;
 	}
-	if(parent) {
-		parent->findObject<esl::object::Object>(id);
+	if(showOutput->ostream == nullptr && showOutput->streamReal == nullptr) {
+		return;
 	}
-	return nullptr;
+
+	std::uint64_t suppressed = 0;
+	bool withStacktrace = showStacktrace;
+	if((exceptionRateLimit > 0 || stacktraceSample > 0) && !admitException(exceptionPointer, suppressed, withStacktrace)) {
+		return;
+	}
+
+	if(!asynchronousExceptions) {
+		writeException(exceptionPointer, suppressed, 0, withStacktrace);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(exceptionReporterMutex);
+	if(!exceptionReporter) {
+		exceptionReporter.reset(new ExceptionReporter(*this, exceptionQueueSize));
+	}
+	exceptionReporter->push(exceptionPointer, suppressed, withStacktrace);
 }
 
-void Context::addRawObject(const std::string& id, std::unique_ptr<esl::object::Object> object) {
-	Context* context = dynamic_cast<Context*>(object.get());
+void Context::writeException(std::exception_ptr exceptionPointer, std::uint64_t suppressed, std::uint64_t dropped, bool withStacktrace) {
+	std::string& buffer = exceptionBuffer;
+	buffer.clear();
+	if(dropped > 0) {
+		buffer += "Dropped ";
+		appendNumber(buffer, dropped);
+		buffer += " exceptions because the exception queue was full.\n";
+	}
+	if(suppressed > 0) {
+		buffer += "Suppressed ";
+		appendNumber(buffer, suppressed);
+		buffer += " identical exceptions before this one.\n";
+	}
+	renderException(buffer, 1, exceptionPointer, withStacktrace);
 
-	if(id.empty()) {
-		entries.push_back(std::unique_ptr<Entry>(new Entry(std::move(object))));
+	/* flushing the log appenders is expensive, so it is done at most once per second */
+	std::int64_t second = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	bool flush = exceptionFlushSecond.exchange(second, std::memory_order_relaxed) != second;
+
+	if(showOutput->ostream) {
+		if(flush) {
+			Logger::flush(*showOutput->ostream);
+		}
+		showOutput->ostream->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 	}
 	else {
-		if(objects.count(id) == 0) {
-	        throw std::runtime_error("Cannot add object with id '" + id + "' because there exists already an object with same id.");
+		esl::logging::Location location{};
+		if(flush) {
+			Logger::flush(*showOutput->streamReal);
 		}
-		objects.insert(std::make_pair(id, IdElement(std::move(object))));
+		(*showOutput->streamReal)(location.object, location.function, location.file, location.line) << buffer;
 	}
+}
 
-	if(context) {
-		context->setParent(this);
+/* false if the exception is suppressed by 'exception-rate-limit' */
+bool Context::admitException(std::exception_ptr exceptionPointer, std::uint64_t& suppressed, bool& withStacktrace) {
+	std::uint64_t key;
+	try {
+		std::rethrow_exception(exceptionPointer);
+	}
+	catch(const std::exception& e) {
+		key = typeid(e).hash_code() ^ (std::hash<std::string_view>()(e.what() ? e.what() : "") * 31);
+	}
+	catch(...) {
+		key = 1;
+	}
+	if(key == 0) {
+		/* 0 marks an unused slot */
+		key = 1;
+	}
+
+	std::int64_t second = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	/* Probe a few slots for the exception. If it is not found, an unused slot is taken or
+	 * the slot that has been used least recently is evicted. */
+	ExceptionSlot* slotPtr = nullptr;
+	ExceptionSlot* evictPtr = nullptr;
+	for(std::size_t i = 0; i < exceptionSlotProbes && slotPtr == nullptr; ++i) {
+		ExceptionSlot& candidate = exceptionSlots[(key + i) % exceptionSlots.size()];
+		std::uint64_t candidateKey = candidate.key.load(std::memory_order_relaxed);
+		if(candidateKey == key) {
+			slotPtr = &candidate;
+		}
+		else if(candidateKey == 0 && candidate.key.compare_exchange_strong(candidateKey, key, std::memory_order_relaxed)) {
+			slotPtr = &candidate;
+			slotPtr->second.store(second, std::memory_order_relaxed);
+		}
+		else if(candidateKey == key) {
+			/* another thread has just taken the unused slot for the same exception */
+			slotPtr = &candidate;
+		}
+		else if(evictPtr == nullptr || candidate.second.load(std::memory_order_relaxed) < evictPtr->second.load(std::memory_order_relaxed)) {
+			evictPtr = &candidate;
+		}
+	}
+	if(slotPtr == nullptr) {
+		slotPtr = evictPtr;
+		slotPtr->key.store(key, std::memory_order_relaxed);
+		slotPtr->second.store(second, std::memory_order_relaxed);
+		slotPtr->count.store(0, std::memory_order_relaxed);
+		slotPtr->occurrences.store(0, std::memory_order_relaxed);
+		slotPtr->suppressed.store(0, std::memory_order_relaxed);
+	}
+	ExceptionSlot& slot = *slotPtr;
+
+	if(slot.second.exchange(second, std::memory_order_relaxed) != second) {
+		slot.count.store(0, std::memory_order_relaxed);
 	}
+
+	std::uint64_t occurrence = slot.occurrences.fetch_add(1, std::memory_order_relaxed);
+	if(exceptionRateLimit > 0 && slot.count.fetch_add(1, std::memory_order_relaxed) >= exceptionRateLimit) {
+		slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+	if(stacktraceSample > 0) {
+		withStacktrace = withStacktrace && occurrence % stacktraceSample == 0;
+	}
+	return true;
 }
 
+void Context::initializeContext(esl::object::Context&) {
+	initialize(*getState());
+}
 
-void Context::printException(std::ostream& stream, int level, const std::exception& e, const std::string& plainException, const std::string& plainDetails, const esl::system::Stacktrace* stacktrace) {
-	std::string levelStr = "[" + std::to_string(level) + "]";
+void Context::runAfterInitialize(const void* owner, std::function<void()> function) {
+	if(!InitializeLock::isLocked()) {
+		function();
+		return;
+	}
 
-	stream << levelStr << " Exception : " << plainException << "\n";
-	stream << levelStr << " What      : " << (e.what() ? e.what() : "") << "\n";
-	if(plainDetails.empty() == false) {
-		stream << levelStr << " Details   : " << plainDetails << "\n";
+	Context& root = getRoot();
+	std::lock_guard<std::mutex> lock(root.afterInitializeMutex);
+	root.afterInitialize.emplace_back(owner, std::move(function));
+}
+
+void Context::cancelAfterInitialize(const void* owner) noexcept {
+	Context& root = getRoot();
+	std::lock_guard<std::mutex> lock(root.afterInitializeMutex);
+	for(auto iter = root.afterInitialize.begin(); iter != root.afterInitialize.end();) {
+		iter = iter->first == owner ? root.afterInitialize.erase(iter) : std::next(iter);
 	}
+}
 
-	if(showStacktrace) {
-		if(stacktrace) {
-			stream << levelStr << " Stacktrace:\n";
-			stacktrace->dump(stream);
+Context& Context::getRoot() noexcept {
+	Context* root = this;
+	while(root->parent) {
+		root = root->parent;
+	}
+	return *root;
+}
+
+/* Functions are taken one at a time, because a function might cancel or queue other functions */
+void Context::runPendingAfterInitialize() {
+	if(InitializeLock::isLocked()) {
+		return;
+	}
+
+	Context& root = getRoot();
+	while(true) {
+		std::function<void()> function;
+		{
+			std::lock_guard<std::mutex> lock(root.afterInitializeMutex);
+			if(root.afterInitialize.empty()) {
+				break;
+			}
+			function = std::move(root.afterInitialize.front().second);
+			root.afterInitialize.erase(root.afterInitialize.begin());
+		}
+		function();
+	}
+}
+
+void Context::initialize(State& currentState) {
+	if(!currentState.initialized.load(std::memory_order_acquire)) {
+		InitializeLock lock(*this);
+		if(initializing) {
+			return;
+		}
+
+		if(!currentState.initialized.load(std::memory_order_relaxed)) {
+			initializing = true;
+
+			try {
+				initializeState(currentState);
+			}
+			catch(...) {
+				initializing = false;
+				throw;
+			}
+
+			initializing = false;
+			currentState.initialized.store(true, std::memory_order_release);
+
+			/* otherwise the timeline is reported after warmup */
+			if(warmupProcedureIds.empty() && !timelineReported && (timelineOutput || !timelineFile.empty())) {
+				timelineReported = true;
+				reportTimeline();
+			}
+		}
+	}
+
+	/* e.g. worker processes of a process task factory are forked now, when no lock is held */
+	runPendingAfterInitialize();
+
+	/* Not under initializeMutex, because warmup procedures might create lazy objects on other threads.
+	 * A nested context is initialized while its parent holds the lock, so warmup runs afterwards. */
+	if(!warmupProcedureIds.empty() && !warmedUp.load(std::memory_order_acquire)) {
+		runAfterInitialize(this, [this]() {
+			std::call_once(warmupFlag, &Context::warmup, this);
+		});
+	}
+}
+
+void Context::warmup() {
+	Timeline::Step step("warmup");
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	std::vector<esl::processing::Procedure*> procedures;
+	for(const auto& procedureId : warmupProcedureIds) {
+		esl::processing::Procedure* procedure = findObject<esl::processing::Procedure>(procedureId);
+		if(procedure == nullptr) {
+			throw std::runtime_error("Cannot find warmup procedure with id '" + procedureId + "'.");
+		}
+		procedures.push_back(procedure);
+	}
+
+	std::shared_ptr<WarmupProgress> progress(new WarmupProgress(procedures.size()));
+	warmupProgress = progress;
+
+	/* a thread that is still running when the context gets destroyed keeps the objects alive */
+	std::shared_ptr<State> currentState = getState();
+
+	std::vector<std::thread> threads;
+	for(std::size_t i = 0; i < procedures.size(); ++i) {
+		threads.emplace_back([i, procedure = procedures[i], procedureId = warmupProcedureIds[i], progress, currentState]() mutable {
+			try {
+				Timeline::Step procedureStep("warmup", procedureId);
+				object::Context warmupContext;
+				procedure->procedureRun(warmupContext);
+			}
+			catch(const std::exception& e) {
+				logger.warn << "Warmup procedure '" << procedureId << "' failed: " << e.what() << "\n";
+			}
+			catch(...) {
+				logger.warn << "Warmup procedure '" << procedureId << "' failed with unknown exception.\n";
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(progress->mutex);
+				progress->finished[i] = true;
+				++progress->finishedCount;
+				progress->finishedCV.notify_all();
+			}
+			currentState.reset();
+		});
+	}
+
+	std::unique_lock<std::mutex> progressLock(progress->mutex);
+	auto isFinished = [&progress]() {
+		return progress->finishedCount == progress->finished.size();
+	};
+
+	if(!hasWarmupTimeout) {
+		progress->finishedCV.wait(progressLock, isFinished);
+	}
+	else if(!progress->finishedCV.wait_for(progressLock, warmupTimeout, isFinished)) {
+		logger.warn << "Warmup exceeded its time budget of " << warmupTimeout.count() << " ms. Canceling " << (procedures.size() - progress->finishedCount) << " warmup procedures.\n";
+		for(std::size_t i = 0; i < procedures.size(); ++i) {
+			if(!progress->finished[i]) {
+				procedures[i]->procedureCancel();
+			}
+		}
+	}
+
+	/* A procedure that ignores procedureCancel must not block the start, so its thread is detached */
+	for(std::size_t i = 0; i < threads.size(); ++i) {
+		if(progress->finished[i]) {
+			threads[i].join();
 		}
 		else {
-			stream << levelStr << " Stacktrace: not available\n";
+			logger.warn << "Warmup procedure '" << warmupProcedureIds[i] << "' is still running after it has been canceled.\n";
+			threads[i].detach();
 		}
 	}
+	progressLock.unlock();
 
-	stream << "\n";
+	std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - begin;
+	warmupDuration.store(duration.count());
+	logger.info << "Warmup took " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms.\n";
+	warmedUp.store(true, std::memory_order_release);
 
-	try {
-		std::rethrow_if_nested(e);
+	InitializeLock lock(*this);
+	if(!timelineReported && (timelineOutput || !timelineFile.empty())) {
+		timelineReported = true;
+		reportTimeline();
 	}
-	catch(const esl::com::http::server::exception::StatusCode& nestedException) {
-		printException(stream, level+1, nestedException, "esl::com::http::server::exception::StatusCode", "status code " + std::to_string(nestedException.getStatusCode()), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+}
+
+std::chrono::nanoseconds Context::getWarmupDuration() const noexcept {
+	return std::chrono::nanoseconds(warmupDuration.load());
+}
+
+/* called with locked initializeMutex */
+void Context::initializeState(State& currentState) {
+	Timeline::Step step("initialize-context");
+
+	if(execution == parallel) {
+		/* configuration errors of 'entry-dependency' fail at boot and not with the first call */
+		for(const auto& entryDependency : entryDependencies) {
+			std::size_t maxIndex = entryDependency.first;
+			for(std::size_t dependsOn : entryDependency.second) {
+				maxIndex = std::max(maxIndex, dependsOn);
+			}
+			if(maxIndex >= currentState.entries.size()) {
+				throw std::runtime_error("Invalid definition of 'entry-dependency' with entry " + std::to_string(maxIndex+1) + ". Context has " + std::to_string(currentState.entries.size()) + " entries.");
+			}
+		}
+
+		/* The internal task factory is created before the state gets initialized, so concurrent calls
+		 * never create it. It is kept on reload, because running calls might still use it. */
+		if(taskFactoryId.empty() && !taskFactory) {
+			std::size_t threads = std::min<std::size_t>(std::max<std::size_t>(currentState.entries.size(), 1), 1000);
+			taskFactory.reset(new processing::task::TaskFactory(std::vector<std::pair<std::string, std::string>>{{ "max-threads", std::to_string(threads) }}));
+		}
+	}
+
+	for(std::size_t index = 0; index < currentState.entries.size(); ++index) {
+		Timeline::Step entryStep("initialize", "entry #" + std::to_string(index + 1));
+		DependencyRecorder recorder(*this, &currentState.entries[index]->getObject());
+		currentState.entries[index]->initializeContext(*this);
 	}
-	catch(const esl::database::exception::SqlError& nestedException) {
-		std::stringstream s;
-		nestedException.getDiagnostics().dump(s);
-		printException(stream, level+1, nestedException, "esl::database::exception::SqlError", "error code " + std::to_string(nestedException.getSqlReturnCode()) + "\n" + s.str(), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+	for(auto& object : currentState.objects) {
+		if(object.second->initializeContext) {
+			Timeline::Step objectStep("initialize", object.first.getName());
+			DependencyRecorder recorder(*this, object.second->object.get());
+			object.second->initializeContext->initializeContext(*this);
+			object.second->initializeContext = nullptr;
+		}
 	}
-	catch(const std::runtime_error& nestedException) {
-		printException(stream, level+1, nestedException, "std::runtime_error", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+
+	std::unique_lock<std::shared_mutex> lock(currentState.eventRoutesMutex);
+	currentState.eventEntries.clear();
+	currentState.eventRoutes.clear();
+	for(auto& entry : currentState.entries) {
+		if(entry->hasEvent()) {
+			currentState.eventEntries.push_back(entry.get());
+		}
 	}
-	catch(const std::exception& nestedException) {
-		printException(stream, level+1, nestedException, "std::exception", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+}
+
+void Context::reportTimeline() {
+	if(timelineOutput) {
+		std::ostringstream report;
+		Timeline::report(report);
+
+		if(timelineOutput->ostream) {
+			*timelineOutput->ostream << report.str();
+		}
+		else if(timelineOutput->streamReal) {
+			*timelineOutput->streamReal << report.str();
+		}
 	}
-	catch(...) {
-		stream << "[" + std::to_string(level+1) + "] Exception : unknown\n";
+
+	/* a diagnostics file that cannot be written must not stop the context */
+	if(!timelineFile.empty()) {
+		try {
+			Timeline::writeChromeTrace(timelineFile);
+		}
+		catch(const std::exception& e) {
+			logger.warn << "Cannot write boot timeline to file \"" << timelineFile << "\": " << e.what() << "\n";
+		}
+		catch(...) {
+			logger.warn << "Cannot write boot timeline to file \"" << timelineFile << "\": unknown exception\n";
+		}
 	}
 }
 
-void Context::printException(esl::logging::StreamReal& stream, int level, const std::exception& e, const std::string& plainException, const std::string& plainDetails, const esl::system::Stacktrace* stacktrace, esl::logging::Location location) {
-	std::string levelStr = "[" + std::to_string(level) + "]";
+esl::object::Object* Context::findRawObject(const std::string& id) {
+	esl::object::Object* object = lookupObject(id, object::Symbol::hash(id));
+	DependencyRecorder::record(object);
+	return object;
+}
+
+const esl::object::Object* Context::findRawObject(const std::string& id) const {
+	/* looking up an object is logically const, even if it creates a lazy object or fills the parent cache */
+	esl::object::Object* object = const_cast<Context*>(this)->lookupObject(id, object::Symbol::hash(id));
+	DependencyRecorder::record(object);
+	return object;
+}
+
+/* Inside of procedureRun or onEvent the object is looked up in the state of the call and stays valid
+ * until the call returns. Otherwise it is looked up in the published state and stays valid until
+ * the state gets replaced. */
+esl::object::Object* Context::lookupObject(std::string_view id, std::size_t hash) {
+	std::shared_ptr<State> lazyState;
+	std::shared_ptr<IdElement> lazyElement;
+	{
+		object::Epoch::Guard guard;
+
+		Update* currentUpdate = getUpdate();
+		State* pinnedState = currentUpdate ? nullptr : Pin::find(*this);
+		State& currentState = currentUpdate ? *currentUpdate->state : pinnedState ? *pinnedState : *publishedState.load();
 
-	stream(location.object, location.function, location.file, location.line) << levelStr << " Exception : " << plainException << "\n";
-	stream(location.object, location.function, location.file, location.line) << levelStr << " What      : " << (e.what() ? e.what() : "") << "\n";
-	if(plainDetails.empty() == false) {
-		stream(location.object, location.function, location.file, location.line) << levelStr << " Details   : " << plainDetails << "\n";
+		std::shared_ptr<IdElement>* idElement = currentState.objects.find(id, hash);
+		if(idElement) {
+			esl::object::Object* object = (*idElement)->refObject.load(std::memory_order_acquire);
+			if(object || !(*idElement)->create) {
+				return object;
+			}
+
+			/* creating a lazy object might take long, so it is created outside of the guard */
+			lazyState = currentState.shared_from_this();
+			lazyElement = *idElement;
+		}
+	}
+	if(lazyElement) {
+		return getObject(*lazyState, *lazyElement);
+	}
+	if(parent == nullptr) {
+		return nullptr;
 	}
 
-	if(showStacktrace) {
-		if(stacktrace) {
-			stream(location.object, location.function, location.file, location.line) << levelStr << " Stacktrace:\n";
-			stacktrace->dump(stream, location);
+	/* A state of an ancestor that is pinned or updated by this thread is not the published one.
+	 * Its objects are neither taken from the cache nor stored in it. */
+	for(const Context* ancestor = parent; ancestor; ancestor = ancestor->parent) {
+		if(ancestor->getUpdate() || Pin::find(*ancestor)) {
+			return parent->lookupObject(id, hash);
 		}
-		else {
-			stream(location.object, location.function, location.file, location.line) << levelStr << " Stacktrace: not available\n";
+	}
+
+	ParentCacheSlot& slot = parentCache[hash % parentCache.size()];
+	std::uint64_t generation = objectsGeneration.load(std::memory_order_acquire);
+
+	unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+	if((sequence & 1) == 0) {
+		const std::string* name = slot.name.load(std::memory_order_relaxed);
+		esl::object::Object* object = slot.object.load(std::memory_order_relaxed);
+		std::uint64_t slotGeneration = slot.generation.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if(slot.sequence.load(std::memory_order_relaxed) == sequence && slotGeneration == generation && name && *name == id) {
+			return object;
 		}
 	}
 
-	stream(location.object, location.function, location.file, location.line) << "\n";
+	esl::object::Object* parentObject = parent->lookupObject(id, hash);
 
-	try {
-		std::rethrow_if_nested(e);
+	if(parentObject && (sequence & 1) == 0 && slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire)) {
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.name.store(&object::Symbol::intern(id).getName(), std::memory_order_relaxed);
+		slot.object.store(parentObject, std::memory_order_relaxed);
+		slot.generation.store(generation, std::memory_order_relaxed);
+		slot.sequence.store(sequence + 2, std::memory_order_release);
 	}
-	catch(const esl::com::http::server::exception::StatusCode& nestedException) {
-		printException(stream, level+1, nestedException, "esl::com::http::server::exception::StatusCode", "status code " + std::to_string(nestedException.getStatusCode()), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
+
+	return parentObject;
+}
+
+esl::object::Object* Context::getObject(State& currentState, IdElement& idElement) {
+	esl::object::Object* object = idElement.refObject.load(std::memory_order_acquire);
+	if(object || !idElement.create) {
+		return object;
 	}
-	catch(const esl::database::exception::SqlError& nestedException) {
-		std::stringstream s;
-		nestedException.getDiagnostics().dump(s);
-		printException(stream, level+1, nestedException, "esl::database::exception::SqlError", "error code " + std::to_string(nestedException.getSqlReturnCode()) + "\n" + s.str(), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
+
+	/* If create() throws, the next lookup tries again.
+	 * initializeMutex must not be locked inside call_once: A thread holding initializeMutex might
+	 * look up the same object and wait for call_once, while call_once would wait for initializeMutex. */
+	std::call_once(idElement.createFlag, [&idElement]() {
+		idElement.createdObject = idElement.create();
+	});
+
+	{
+		InitializeLock lock(*this);
+		object = idElement.refObject.load(std::memory_order_acquire);
+		if(object == nullptr) {
+			/* createdObject is empty if initializeContext threw on a previous lookup, then it is called again */
+			if(idElement.createdObject) {
+				idElement.object = std::move(idElement.createdObject);
+				idElement.initializeContext = dynamic_cast<esl::object::InitializeContext*>(idElement.object.get());
+			}
+
+			/* Otherwise it is initialized together with all other objects. If the context is initializing
+			 * right now, this thread is inside the loop of initializeContext that might have passed this element already. */
+			if(idElement.initializeContext && (currentState.initialized.load() || initializing)) {
+				DependencyRecorder recorder(*this, idElement.object.get());
+				idElement.initializeContext->initializeContext(*this);
+				idElement.initializeContext = nullptr;
+			}
+
+			object = idElement.object.get();
+			idElement.refObject.store(object, std::memory_order_release);
+		}
 	}
-	catch(const std::runtime_error& nestedException) {
-		printException(stream, level+1, nestedException, "std::runtime_error", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
+
+	/* e.g. a lazy object that has been initialized right now */
+	runPendingAfterInitialize();
+
+	return object;
+}
+
+void Context::addRawObject(const std::string& id, std::unique_ptr<esl::object::Object> object) {
+	Context* context = dynamic_cast<Context*>(object.get());
+
+	updateState(nullptr, [this, &id, &object](State& newState) {
+		if(id.empty()) {
+			newState.entries.push_back(std::shared_ptr<Entry>(new Entry(std::move(object))));
+			newState.entrySignatures.push_back(installSignature);
+		}
+		else {
+			if(newState.objects.find(id)) {
+		        throw std::runtime_error("Cannot add object with id '" + id + "' because there exists already an object with same id.");
+			}
+			std::shared_ptr<IdElement> idElement(new IdElement(std::move(object)));
+			idElement->signature = installSignature;
+			newState.objects.emplace(object::Symbol::intern(id), std::move(idElement));
+		}
+	});
+
+	if(context) {
+		context->setParent(this);
 	}
-	catch(const std::exception& nestedException) {
-		printException(stream, level+1, nestedException, "std::exception", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
+}
+
+thread_local unsigned int Context::InitializeLock::locks = 0;
+
+Context::InitializeLock::InitializeLock(Context& context)
+: lock(context.initializeMutex)
+{
+	++locks;
+}
+
+Context::InitializeLock::~InitializeLock() {
+	--locks;
+}
+
+bool Context::InitializeLock::isLocked() noexcept {
+	return locks > 0;
+}
+
+thread_local Context::Pin* Context::Pin::pins = nullptr;
+
+Context::Pin::Pin(const Context& aContext, State& aState)
+: context(aContext),
+  state(aState),
+  previous(pins)
+{
+	pins = this;
+}
+
+Context::Pin::~Pin() {
+	pins = previous;
+}
+
+Context::State* Context::Pin::find(const Context& context) noexcept {
+	for(Pin* pin = pins; pin; pin = pin->previous) {
+		if(&pin->context == &context) {
+			return &pin->state;
+		}
 	}
-	catch(...) {
-		stream(location.object, location.function, location.file, location.line) << "[" + std::to_string(level+1) + "] Exception : unknown\n";
+	return nullptr;
+}
+
+Context::Update* Context::getUpdate() const noexcept {
+	Update* currentUpdate = update.load(std::memory_order_acquire);
+	return currentUpdate && currentUpdate->thread == std::this_thread::get_id() ? currentUpdate : nullptr;
+}
+
+/* The returned state stays alive as long as it is used, even if another state gets published meanwhile */
+std::shared_ptr<Context::State> Context::getState() const {
+	if(Update* currentUpdate = getUpdate()) {
+		return currentUpdate->state;
+	}
+	if(State* pinnedState = Pin::find(*this)) {
+		return pinnedState->shared_from_this();
 	}
+
+	object::Epoch::Guard guard;
+	return publishedState.load()->shared_from_this();
 }
 
-void Context::printException(std::ostream& stream, std::exception_ptr exceptionPointer) {
+/* Runs 'apply' on a new state and publishes it afterwards. Meanwhile the calling thread reads and writes
+ * the new state and other threads keep using the published state. Writers are serialized by initializeMutex.
+ * The new state is a copy of the published state, except for reload, that starts with an empty state.
+ * A Batch keeps an update open, so callers that add many objects copy the state once. */
+void Context::updateState(Reload* reload, const std::function<void(State&)>& apply) {
+	if(Update* currentUpdate = getUpdate()) {
+		/* nested, e.g. objects added by the configuration */
+		apply(*currentUpdate->state);
+		return;
+	}
+
+	InitializeLock lock(*this);
+
+	Update newUpdate;
+	newUpdate.thread = std::this_thread::get_id();
+	newUpdate.state = std::make_shared<State>();
+	newUpdate.reload = reload;
+	if(reload == nullptr) {
+		newUpdate.state->entries = state->entries;
+		newUpdate.state->entrySignatures = state->entrySignatures;
+		newUpdate.state->objects = state->objects;
+	}
+
+	update.store(&newUpdate, std::memory_order_release);
 	try {
-		std::rethrow_exception(exceptionPointer);
-    }
-	catch(const esl::com::http::server::exception::StatusCode& nestedException) {
-		printException(stream, 1, nestedException, "esl::com::http::server::exception::StatusCode", "status code " + std::to_string(nestedException.getStatusCode()), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+		apply(*newUpdate.state);
 	}
-	catch(const esl::database::exception::SqlError& nestedException) {
-		std::stringstream s;
-		nestedException.getDiagnostics().dump(s);
-		printException(stream, 1, nestedException, "esl::database::exception::SqlError", "error code " + std::to_string(nestedException.getSqlReturnCode()) + "\n" + s.str(), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+	catch(...) {
+		update.store(nullptr);
+		/* parent caches of other contexts might refer to objects of the discarded state */
+		objectsGeneration.fetch_add(1);
+		throw;
 	}
-	catch(const std::runtime_error& nestedException) {
-		printException(stream, 1, nestedException, "std::runtime_error", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+	update.store(nullptr);
+
+	publishState(std::move(newUpdate.state));
+}
+
+/* called with locked initializeMutex */
+Context::Batch::Batch(Context& aContext)
+: context(aContext),
+  lock(aContext),
+  uncaughtExceptions(std::uncaught_exceptions())
+{
+	/* nested, objects are added to the running update */
+	if(context.getUpdate()) {
+		return;
 	}
-	catch(const std::exception& nestedException) {
-		printException(stream, 1, nestedException, "std::exception", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr);
+
+	update.thread = std::this_thread::get_id();
+	update.state = std::make_shared<State>();
+	update.state->entries = context.state->entries;
+	update.state->entrySignatures = context.state->entrySignatures;
+	update.state->objects = context.state->objects;
+	context.update.store(&update, std::memory_order_release);
+}
+
+Context::Batch::~Batch() {
+	if(!update.state) {
+		return;
 	}
-	catch(...) {
-		stream << "[1] Exception : unknown\n";
+
+	context.update.store(nullptr);
+	if(std::uncaught_exceptions() > uncaughtExceptions) {
+		/* parent caches of other contexts might refer to objects of the discarded state */
+		objectsGeneration.fetch_add(1);
+		return;
 	}
+
+	context.publishState(std::move(update.state));
 }
 
-void Context::printException(esl::logging::StreamReal& stream, std::exception_ptr exceptionPointer, esl::logging::Location location) {
+void Context::publishState(std::shared_ptr<State> newState) {
+	std::shared_ptr<State> oldState = std::move(state);
+	state = std::move(newState);
+	publishedState.store(state.get());
+	objectsGeneration.fetch_add(1);
+
+	/* Readers might still look at the old state without holding it. Calls that hold it keep it alive longer. */
+	object::Epoch::retire(this, [oldState]() mutable {
+		oldState.reset();
+	});
+}
+
+void Context::addSource(bool isFile, const boost::filesystem::path& file, const std::string& data, const config::context::Context& config) {
+	std::ostringstream savedConfig;
+	config.save(savedConfig);
+	sources.push_back(Source{isFile, file, data, savedConfig.str()});
+}
+
+void Context::renderException(std::string& buffer, int level, std::exception_ptr exceptionPointer, bool withStacktrace) const {
 	try {
 		std::rethrow_exception(exceptionPointer);
-    }
-	catch(const esl::com::http::server::exception::StatusCode& nestedException) {
-		printException(stream, 1, nestedException, "esl::com::http::server::exception::StatusCode", "status code " + std::to_string(nestedException.getStatusCode()), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
 	}
-	catch(const esl::database::exception::SqlError& nestedException) {
-		std::stringstream s;
-		nestedException.getDiagnostics().dump(s);
-		printException(stream, 1, nestedException, "esl::database::exception::SqlError", "error code " + std::to_string(nestedException.getSqlReturnCode()) + "\n" + s.str(), showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
+	catch(const std::exception& e) {
+		renderException(buffer, level, e, withStacktrace);
 	}
-	catch(const std::runtime_error& nestedException) {
-		printException(stream, 1, nestedException, "std::runtime_error", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
+	catch(...) {
+		appendLevel(buffer, level);
+		buffer += " Exception : unknown\n";
+	}
+}
+
+void Context::renderException(std::string& buffer, int level, const std::exception& e, bool withStacktrace) const {
+	appendLevel(buffer, level);
+	buffer += " Exception : ";
+	if(dynamic_cast<const esl::com::http::server::exception::StatusCode*>(&e)) {
+		buffer += "esl::com::http::server::exception::StatusCode";
+	}
+	else if(dynamic_cast<const esl::database::exception::SqlError*>(&e)) {
+		buffer += "esl::database::exception::SqlError";
+	}
+	else if(dynamic_cast<const std::runtime_error*>(&e)) {
+		buffer += "std::runtime_error";
+	}
+	else {
+		buffer += "std::exception";
+	}
+	buffer += "\n";
+
+	appendLevel(buffer, level);
+	buffer += " What      : ";
+	buffer += e.what() ? e.what() : "";
+	buffer += "\n";
+
+	if(const esl::com::http::server::exception::StatusCode* statusCode = dynamic_cast<const esl::com::http::server::exception::StatusCode*>(&e)) {
+		appendLevel(buffer, level);
+		buffer += " Details   : status code ";
+		appendNumber(buffer, statusCode->getStatusCode());
+		buffer += "\n";
+	}
+	else if(const esl::database::exception::SqlError* sqlError = dynamic_cast<const esl::database::exception::SqlError*>(&e)) {
+		appendLevel(buffer, level);
+		buffer += " Details   : error code ";
+		appendNumber(buffer, sqlError->getSqlReturnCode());
+		buffer += "\n";
+
+		sqlError->getDiagnostics().dump(getDumpStream(buffer));
+		buffer += "\n";
+	}
+
+	if(showStacktrace) {
+		const esl::system::Stacktrace* stacktrace = withStacktrace ? esl::system::Stacktrace::get(e) : nullptr;
+		appendLevel(buffer, level);
+		if(stacktrace) {
+			buffer += " Stacktrace:\n";
+			stacktrace->dump(getDumpStream(buffer));
+		}
+		else if(withStacktrace) {
+			buffer += " Stacktrace: not available\n";
+		}
+		else {
+			buffer += " Stacktrace: not sampled\n";
+		}
+	}
+
+	buffer += "\n";
+
+	try {
+		std::rethrow_if_nested(e);
 	}
 	catch(const std::exception& nestedException) {
-		printException(stream, 1, nestedException, "std::exception", "", showStacktrace ? esl::system::Stacktrace::get(nestedException) : nullptr, location);
+		renderException(buffer, level + 1, nestedException, withStacktrace);
 	}
 	catch(...) {
-		stream(location.object, location.function, location.file, location.line) << "[1] Exception : unknown\n";
+		appendLevel(buffer, level + 1);
+		buffer += " Exception : unknown\n";
 	}
 }
 
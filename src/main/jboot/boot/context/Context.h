@@ -20,6 +20,9 @@
 #define JBOOT_BOOT_CONTEXT_CONTEXT_H_
 
 #include <jboot/boot/context/Entry.h>
+#include <jboot/object/AfterInitialize.h>
+#include <jboot/object/EventBatch.h>
+#include <jboot/object/SymbolMap.h>
 
 #include <esl/boot/context/Context.h>
 #include <esl/logging/StreamReal.h>
@@ -31,26 +34,47 @@
 #include <esl/processing/Procedure.h>
 #include <esl/system/Stacktrace.h>
 
+#include <esl/processing/TaskFactory.h>
+
 #include <boost/filesystem/path.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
-#include <map>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <ostream>
+#include <map>
 #include <set>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace jboot {
+namespace config {
+namespace context {
+class Context;
+} /* namespace context */
+} /* namespace config */
+
 namespace boot {
 namespace context {
 
-class Context : public esl::boot::context::Context, public esl::object::InitializeContext  {
+class Context : public esl::boot::context::Context, public esl::object::InitializeContext, public object::EventBatch, public object::AfterInitialize {
 public:
 	static std::unique_ptr<esl::boot::context::Context> create(const std::vector<std::pair<std::string, std::string>>& settings);
 
 	Context(const std::vector<std::pair<std::string, std::string>>& settings);
+	~Context();
 
 	void setParent(Context* parentContext);
 
@@ -59,12 +83,60 @@ public:
 	esl::boot::context::Context& addReference(const std::string& destinationId, const std::string& sourceId) override;
 	int getReturnCode() const override;
 
+	/* The object is created by 'create' when it is looked up the first time. */
+	void addLazyObject(const std::string& id, std::function<std::unique_ptr<esl::object::Object>()> create);
+
+	/* Default for attribute 'lazy' of objects in the configuration */
+	bool getLazyObjects() const noexcept;
+
+	/* Number of threads used to create the objects of a configuration */
+	unsigned int getInstallThreads() const noexcept;
+
+	/* Time the procedures of 'warmup-procedure' took, 0 before warmup has finished */
+	std::chrono::nanoseconds getWarmupDuration() const noexcept;
+
 	void onEvent(const esl::object::Object& object) override;
+	void onEvents(const esl::object::Object* const* objects, std::size_t count) override;
 	std::set<std::string> getObjectIds() const override;
 	void procedureRun(esl::object::Context& context) override;
 
 	void initializeContext(esl::object::Context&) override;
 
+	/* Functions are queued at the top level context and run after its initialization has finished,
+	 * without holding the initialization lock of any context. */
+	void runAfterInitialize(const void* owner, std::function<void()> function) override;
+	void cancelAfterInitialize(const void* owner) noexcept override;
+
+	/* Parses the configuration added by addFile and addData again and replaces all objects and entries
+	 * at once. Objects of unchanged configuration entries are taken over, only changed entries are
+	 * created again. Calls that are running already finish with the objects they started with.
+	 * Objects that implement InitializeContext are created again, because they might keep objects of
+	 * the old configuration, unless they implement object::Reusable. */
+	void reload();
+
+	/* Used by the configuration while installing one entry. Objects added while an Install is alive
+	 * are tagged with the signature of the entry, so reload() can find them again. */
+	class Install {
+	public:
+		Install(Context& context, const std::string& signature);
+		~Install();
+
+		/* true if reload() took over the object of an unchanged entry, so it must not be created again */
+		bool isReused() const noexcept;
+
+	private:
+		Context& context;
+		bool reused = false;
+	};
+
+	/* true if reload() will take over the object of an entry with this signature */
+	bool isReused(const std::string& signature) const;
+
+	/* Objects and entries added by the calling thread while a Batch is alive are published together
+	 * when it is destroyed. Otherwise each addObject publishes a new copy of all objects.
+	 * Nothing is published if the batch is destroyed by an exception. */
+	class Batch;
+
 protected:
 	esl::object::Object* findRawObject(const std::string& id) override;
 	const esl::object::Object* findRawObject(const std::string& id) const override;
@@ -73,6 +145,11 @@ protected:
 private:
 	Context* parent = nullptr;
 
+	/* declared after parent and before the state, because objects of the state cancel their functions
+	 * while they are destroyed. Only used by the top level context. */
+	std::mutex afterInitializeMutex;
+	std::vector<std::pair<const void*, std::function<void()>>> afterInitialize;
+
 	enum HandleException {
 		rethrow,
 		stop,         // (add or override exception object)
@@ -105,34 +182,292 @@ private:
 	};
 	std::unique_ptr<ShowOutput> showOutput;
 
-	std::vector<std::unique_ptr<Entry>> entries;
+	/* Identical exceptions have the same type and what(). With 'exception-rate-limit' at most that many
+	 * identical exceptions are shown per second, the others are counted and reported with the next one
+	 * that is shown. With 'stacktrace-sample' only every n-th identical exception shows its stacktrace.
+	 * Exceptions are counted in a small hash table by the hash of type and what(). If none of the probed
+	 * slots belongs to the exception, the least recently used one is evicted and its counts are lost. */
+	unsigned int exceptionRateLimit = 0;
+	unsigned int stacktraceSample = 0;
+	struct ExceptionSlot {
+		std::atomic<std::uint64_t> key { 0 };
+		std::atomic<std::int64_t> second { 0 };
+		std::atomic<unsigned int> count { 0 };
+		std::atomic<std::uint64_t> suppressed { 0 };
+		std::atomic<std::uint64_t> occurrences { 0 };
+	};
+	std::array<ExceptionSlot, 64> exceptionSlots;
+	static constexpr std::size_t exceptionSlotProbes = 8;
+
+	/* second in which the log appenders have been flushed the last time before an exception was shown */
+	std::atomic<std::int64_t> exceptionFlushSecond { -1 };
+
+	/* With exception-reporting = asynchronous the calling thread only queues the exception and a
+	 * reporter thread writes it. The reporter is started with the first exception and writes all
+	 * queued exceptions before the context is destroyed. If the queue is full, exceptions are dropped
+	 * and counted. */
+	bool hasExceptionReporting = false;
+	bool asynchronousExceptions = false;
+	std::size_t exceptionQueueSize = 0;
+	class ExceptionReporter;
+	std::mutex exceptionReporterMutex;
+	std::unique_ptr<ExceptionReporter> exceptionReporter;
+
+	/* boot timeline is reported when the context has been initialized */
+	std::unique_ptr<ShowOutput> timelineOutput;
+	std::string timelineFile;
+	bool timelineReported = false;
+
+	enum Execution {
+		sequential,
+		parallel
+	};
+	bool hasExecution = false;
+	Execution execution = sequential;
+
+	/* used for execution = parallel. If no task factory id is specified, an internal task factory
+	 * is created with one thread per entry when the context is initialized. */
+	std::string taskFactoryId;
+	std::unique_ptr<esl::processing::TaskFactory> taskFactory;
+
+	/* pairs of entry index and indices of entries that have to be finished before, 0-based */
+	std::vector<std::pair<std::size_t, std::vector<std::size_t>>> entryDependencies;
+
 	struct IdElement {
 		IdElement(std::unique_ptr<esl::object::Object> aObject)
 		: object(std::move(aObject)),
-		  refObject(*object),
-		  initializeContext(dynamic_cast<esl::object::InitializeContext*>(&refObject))
+		  refObject(object.get()),
+		  initializeContext(dynamic_cast<esl::object::InitializeContext*>(object.get()))
 		{ }
 
-		IdElement(esl::object::Object& refObject)
-		: refObject(refObject),
+		IdElement(esl::object::Object& aRefObject)
+		: refObject(&aRefObject),
 		  initializeContext(nullptr)
 		{ }
 
+		IdElement(std::function<std::unique_ptr<esl::object::Object>()> aCreate)
+		: initializeContext(nullptr),
+		  create(std::move(aCreate))
+		{ }
+
 		std::unique_ptr<esl::object::Object> object;
-		esl::object::Object& refObject;
+		/* nullptr as long as a lazy object has not been created */
+		std::atomic<esl::object::Object*> refObject { nullptr };
 		esl::object::InitializeContext* initializeContext;
+
+		std::function<std::unique_ptr<esl::object::Object>()> create;
+		std::once_flag createFlag;
+		/* set by call_once and moved to 'object' while holding initializeMutex */
+		std::unique_ptr<esl::object::Object> createdObject;
+
+		/* signature of the configuration entry, empty if the object has not been added by the configuration */
+		std::string signature;
+	};
+
+	/* Entries and objects of the context. A state is never modified after it has been published,
+	 * except for initialization. Writers publish a new version and readers look up objects without locks.
+	 * Entries and id elements are shared between versions, so a lazy object is created once for all versions. */
+	struct State : public std::enable_shared_from_this<State> {
+		std::vector<std::shared_ptr<Entry>> entries;
+		/* signatures of the configuration entries the entries have been installed from */
+		std::vector<std::string> entrySignatures;
+
+		object::SymbolMap<std::shared_ptr<IdElement>> objects;
+
+		/* Entries that handle events, built by initializeContext. Entries that receive events of a
+		 * type are looked up once per type and stored in eventRoutes. */
+		std::vector<Entry*> eventEntries;
+		std::shared_mutex eventRoutesMutex;
+		std::unordered_map<std::type_index, std::vector<Entry*>> eventRoutes;
+
+		/* procedureRun and onEvent initialize the state every time, so the common case that
+		 * everything is initialized already costs a single atomic load. */
+		std::atomic<bool> initialized { false };
+	};
+	/* The published state is owned by 'state' and read through 'publishedState'. A replaced state is
+	 * retired and released when no reader is looking at it anymore. Calls that are running keep the
+	 * state they have started with by a shared pointer. */
+	std::shared_ptr<State> state = std::make_shared<State>();
+	std::atomic<State*> publishedState { state.get() };
+
+	/* Configuration added by addFile and addData, parsed again by reload() */
+	struct Source {
+		bool isFile;
+		boost::filesystem::path file;
+		std::string data;
+		/* configuration as written by save(), to detect changes */
+		std::string savedConfig;
+	};
+	std::vector<Source> sources;
+
+	/* Objects of the old state that reload() can take over, found by the signature of their entry */
+	struct Reusable {
+		object::Symbol id;
+		std::shared_ptr<IdElement> idElement;
+		std::shared_ptr<Entry> entry;
+	};
+	struct Reload {
+		std::multimap<std::string, Reusable> reusables;
+		std::size_t reused = 0;
+		std::size_t installed = 0;
+	};
+
+	/* New version of the state that is built by a writer. Only the writing thread reads and writes it
+	 * until it gets published. */
+	struct Update {
+		std::thread::id thread;
+		std::shared_ptr<State> state;
+		Reload* reload = nullptr;
+	};
+	std::atomic<Update*> update { nullptr };
+	/* signature set by Install */
+	std::string installSignature;
+
+	/* The state a thread runs procedureRun or onEvent with. Objects are looked up in this state,
+	 * so a call sees the same objects from its beginning to its end, even if a new state gets published. */
+	class Pin {
+	public:
+		Pin(const Context& context, State& state);
+		~Pin();
+
+		static State* find(const Context& context) noexcept;
+
+	private:
+		static thread_local Pin* pins;
+
+		const Context& context;
+		State& state;
+		Pin* previous;
+	};
+
+	Update* getUpdate() const noexcept;
+	std::shared_ptr<State> getState() const;
+	void updateState(Reload* reload, const std::function<void(State&)>& apply);
+	void publishState(std::shared_ptr<State> newState);
+	void addSource(bool isFile, const boost::filesystem::path& file, const std::string& data, const config::context::Context& config);
+
+	/* Direct mapped cache of objects that have been found in a parent context.
+	 * Readers are lock free. A writer takes a slot by making its sequence odd and skips caching
+	 * if the slot is taken already. A slot is valid only for the generation it has been written in.
+	 * The generation is incremented when any boot context gets a new object or a new parent.
+	 * Only objects of published states are cached. */
+	struct ParentCacheSlot {
+		std::atomic<unsigned int> sequence { 0 };
+		std::atomic<const std::string*> name { nullptr };
+		std::atomic<esl::object::Object*> object { nullptr };
+		std::atomic<std::uint64_t> generation { 0 };
+	};
+	std::array<ParentCacheSlot, 64> parentCache;
+
+	bool lazyObjects = false;
+	unsigned int installThreads = 0;
+
+	/* Warmup procedures run concurrently once after the first initialization, before any entry runs.
+	 * Callers of procedureRun wait for them, so servers start accepting afterwards. Procedures still
+	 * running after 'warmup-timeout-ms' get canceled and are not waited for. */
+	std::vector<std::string> warmupProcedureIds;
+	bool hasWarmupTimeout = false;
+	std::chrono::milliseconds warmupTimeout { 0 };
+	std::once_flag warmupFlag;
+	std::atomic<bool> warmedUp { false };
+	std::atomic<std::chrono::nanoseconds::rep> warmupDuration { 0 };
+	/* shared with the warmup threads, so threads that exceed the time budget can be detached.
+	 * The destructor waits for them up to 'shutdown-timeout-ms', or 'warmup-timeout-ms' if it is not defined. */
+	struct WarmupProgress;
+	std::shared_ptr<WarmupProgress> warmupProgress;
+
+	/* With shutdown = parallel the destructor destroys owned objects concurrently. An object is
+	 * destroyed after all objects that have looked it up in initializeContext, references resolve
+	 * to the object they refer to. Objects that are not destroyed until the deadline are leaked. */
+	enum Shutdown {
+		sequentialShutdown,
+		parallelShutdown
+	};
+	bool hasShutdown = false;
+	Shutdown shutdown = sequentialShutdown;
+	bool hasShutdownTimeout = false;
+	std::chrono::milliseconds shutdownTimeout { 0 };
+
+	/* pairs of dependent object and the object it has looked up, recorded for shutdown = parallel */
+	class DependencyRecorder;
+	std::mutex dependenciesMutex;
+	std::vector<std::pair<const esl::object::Object*, const esl::object::Object*>> dependencies;
+
+	esl::object::Object* lookupObject(std::string_view id, std::size_t hash);
+	esl::object::Object* getObject(State& currentState, IdElement& idElement);
+
+	/* locked by writers and by initialization */
+	std::recursive_mutex initializeMutex;
+	bool initializing = false;
+
+	/* Locks initializeMutex and counts the initialization locks held by the thread in any context */
+	class InitializeLock {
+	public:
+		InitializeLock(Context& context);
+		~InitializeLock();
+
+		/* true if the calling thread holds the initialization lock of any context */
+		static bool isLocked() noexcept;
+
+	private:
+		std::lock_guard<std::recursive_mutex> lock;
+		static thread_local unsigned int locks;
+	};
+
+public:
+	class Batch {
+	public:
+		Batch(Context& context);
+		~Batch();
+
+	private:
+		Context& context;
+		InitializeLock lock;
+		Update update;
+		int uncaughtExceptions;
 	};
-	std::map<std::string, IdElement> objects;
+
+private:
 
 	int returnCode = 0;
 
-	void printException(std::ostream& stream, int level, const std::exception& e, const std::string& plainException, const std::string& plainDetails, const esl::system::Stacktrace* stacktrace);
-	void printException(esl::logging::StreamReal& stream, int level, const std::exception& e, const std::string& plainException, const std::string& plainDetails, const esl::system::Stacktrace* stacktrace, esl::logging::Location location);
-//	static inline void printException(esl::logging::StreamEmpty& stream, int level, const std::exception& e, const std::string& plainException, const std::string& plainDetails, esl::logging::Location location) { }
+	void initialize(State& state);
+	void initializeState(State& state);
+	Context& getRoot() noexcept;
+	void runPendingAfterInitialize();
+	void warmup();
+	void shutdownParallel();
+	void procedureRunParallel(esl::object::Context& context, State& state);
+	void showException(std::exception_ptr exceptionPointer);
+	void reportTimeline();
+	const std::vector<Entry*>& getEventRoute(State& state, const std::type_info& type);
+
+	/* Renders into a buffer that is reused by the thread, so an exception is written at once */
+	void renderException(std::string& buffer, int level, std::exception_ptr exceptionPointer, bool withStacktrace) const;
+	void renderException(std::string& buffer, int level, const std::exception& e, bool withStacktrace) const;
+	bool admitException(std::exception_ptr exceptionPointer, std::uint64_t& suppressed, bool& withStacktrace);
+	void writeException(std::exception_ptr exceptionPointer, std::uint64_t suppressed, std::uint64_t dropped, bool withStacktrace);
+
+protected:
+	/* Entries of the state a call has been started with, for contexts that run their entries themselves.
+	 * The state is initialized by the constructor. */
+	class Call {
+	public:
+		Call(Context& context);
+
+		std::size_t getEntryCount() const noexcept;
+
+		/* Runs an entry on the calling thread. Objects are looked up in the state of the call. */
+		void procedureRun(std::size_t index, esl::object::Context& context) const;
+
+	private:
+		Context& owner;
+		std::shared_ptr<State> state;
+	};
 
-	void printException(std::ostream& stream, std::exception_ptr exceptionPointer);
-	void printException(esl::logging::StreamReal& stream, std::exception_ptr exceptionPointer, esl::logging::Location location = esl::logging::Location{});
-//	static inline void printException(esl::logging::StreamEmpty& stream, std::exception_ptr exceptionPointer, esl::logging::Location location) { }
+	/* Handles an exception of an entry as defined by 'handle-exception' and rethrows it for 'rethrow'.
+	 * Returns true if the following entries must not run. */
+	bool onEntryException(esl::object::Context& context, std::exception_ptr exceptionPtr);
 };
 
 } /* namespace context */
@@ -18,6 +18,7 @@
 
 #include <jboot/boot/context/Context.h>
 #include <jboot/boot/context/Entry.h>
+#include <jboot/object/Reusable.h>
 
 namespace jboot {
 namespace boot {
@@ -29,6 +30,8 @@ Entry::Entry(std::unique_ptr<esl::object::Object> aObject)
   initializeContextPtr(dynamic_cast<esl::object::InitializeContext*>(object.get())),
   //context(dynamic_cast<IContext*>(object.get())),
   event(dynamic_cast<esl::object::Event*>(object.get())),
+  eventSubscriber(dynamic_cast<object::EventSubscriber*>(object.get())),
+  eventBatch(dynamic_cast<object::EventBatch*>(object.get())),
   procedure(dynamic_cast<esl::processing::Procedure*>(&refObject))
 { }
 
@@ -36,6 +39,8 @@ Entry::Entry(esl::object::Object& refObject)
 : refObject(refObject),
   initializeContextPtr(nullptr),
   event(dynamic_cast<esl::object::Event*>(&refObject)),
+  eventSubscriber(dynamic_cast<object::EventSubscriber*>(&refObject)),
+  eventBatch(dynamic_cast<object::EventBatch*>(&refObject)),
   procedure(dynamic_cast<esl::processing::Procedure*>(&refObject))
 { }
 
@@ -59,6 +64,17 @@ void Entry::onEvent(const esl::object::Object& object) {
 	}
 }
 
+void Entry::onEvents(const esl::object::Object* const* objects, std::size_t count) {
+	if(eventBatch) {
+		eventBatch->onEvents(objects, count);
+	}
+	else if(event) {
+		for(std::size_t i = 0; i < count; ++i) {
+			event->onEvent(*objects[i]);
+		}
+	}
+}
+
 void Entry::procedureRun(esl::object::Context& context) {
 	if(procedure) {
 		procedure->procedureRun(context);
@@ -77,6 +93,26 @@ void Entry::procedureCancel() {
 	}
 }
 
+bool Entry::hasEvent() const noexcept {
+	return event != nullptr;
+}
+
+bool Entry::isSubscribed(const std::type_info& type) const {
+	return event != nullptr && (eventSubscriber == nullptr || eventSubscriber->isSubscribed(type));
+}
+
+bool Entry::isReusable() const {
+	return object && (dynamic_cast<esl::object::InitializeContext*>(object.get()) == nullptr || dynamic_cast<object::Reusable*>(object.get()) != nullptr);
+}
+
+esl::object::Object& Entry::getObject() const noexcept {
+	return refObject;
+}
+
+std::unique_ptr<esl::object::Object> Entry::releaseObject() noexcept {
+	return std::move(object);
+}
+
 } /* namespace context */
 } /* namespace boot */
 } /* namespace jboot */
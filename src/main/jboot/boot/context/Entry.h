@@ -19,13 +19,18 @@
 #ifndef JBOOT_BOOT_CONTEXT_ENTRY_H_
 #define JBOOT_BOOT_CONTEXT_ENTRY_H_
 
+#include <jboot/object/EventBatch.h>
+#include <jboot/object/EventSubscriber.h>
+
 #include <esl/object/Event.h>
 #include <esl/object/Object.h>
 #include <esl/object/InitializeContext.h>
 #include <esl/object/Context.h>
 #include <esl/processing/Procedure.h>
 
+#include <cstddef>
 #include <memory>
+#include <typeinfo>
 
 namespace jboot {
 namespace boot {
@@ -38,9 +43,23 @@ public:
 
 	void initializeContext(esl::object::Context& context);
 	void onEvent(const esl::object::Object& object);
+	void onEvents(const esl::object::Object* const* objects, std::size_t count);
 	void procedureRun(esl::object::Context& context);
 	void procedureCancel();
 
+	/* false if onEvent does nothing */
+	bool hasEvent() const noexcept;
+	bool isSubscribed(const std::type_info& type) const;
+
+	/* reload() takes over entries that own their object and don't need initializeContext */
+	bool isReusable() const;
+
+	esl::object::Object& getObject() const noexcept;
+
+	/* Takes the owned object, so the context can destroy it in its own order.
+	 * The entry must not be used anymore afterwards. */
+	std::unique_ptr<esl::object::Object> releaseObject() noexcept;
+
 private:
 	std::unique_ptr<esl::object::Object> object;
 	esl::object::Object& refObject;
@@ -48,6 +67,8 @@ private:
 	esl::object::InitializeContext* initializeContextPtr = nullptr;
 	//IContext* context = nullptr;
 	esl::object::Event* event = nullptr;
+	object::EventSubscriber* eventSubscriber = nullptr;
+	object::EventBatch* eventBatch = nullptr;
 	esl::processing::Procedure* procedure = nullptr;
 };
 
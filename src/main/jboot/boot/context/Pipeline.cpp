@@ -0,0 +1,475 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/boot/context/Pipeline.h>
+#include <jboot/Logger.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+namespace {
+Logger logger("jboot::boot::context::Pipeline");
+
+const std::set<std::string> pipelineAttributes {
+	"workers",
+	"stage-workers",
+	"queue-size",
+	"show-metrics",
+	"metrics-interval-ms"
+};
+
+std::vector<std::pair<std::string, std::string>> getContextSettings(const std::vector<std::pair<std::string, std::string>>& settings) {
+	std::vector<std::pair<std::string, std::string>> contextSettings;
+
+	for(const auto& setting : settings) {
+		if(pipelineAttributes.count(setting.first) == 0) {
+			contextSettings.push_back(setting);
+		}
+	}
+
+	return contextSettings;
+}
+
+unsigned int toWorkers(const std::string& value, const std::string& attribute) {
+	long workers;
+	try {
+		workers = std::stol(value);
+	}
+	catch(...) {
+		throw std::runtime_error("Invalid value \"" + value + "\" for attribute '" + attribute + "'.");
+	}
+
+	if(workers <= 0 || workers > 1000) {
+		throw std::runtime_error("Invalid value \"" + value + "\" for attribute '" + attribute + "'. Value has to be between 1 and 1000.");
+	}
+	return static_cast<unsigned int>(workers);
+}
+
+double toMilliseconds(std::chrono::nanoseconds nanoseconds) {
+	return static_cast<double>(nanoseconds.count()) / 1000000.0;
+}
+} /* anonymous namespace */
+
+struct Pipeline::Item {
+	Item(esl::object::Context& aContext, const Call& aCall)
+	: context(aContext),
+	  call(aCall)
+	{ }
+
+	esl::object::Context& context;
+	const Call& call;
+	std::chrono::steady_clock::time_point enqueued;
+
+	std::mutex mutex;
+	std::condition_variable doneCV;
+	bool done = false;
+	std::exception_ptr exception;
+};
+
+class Pipeline::Stage {
+public:
+	Stage(Pipeline& aPipeline, std::size_t aIndex, unsigned int aWorkers, std::size_t aCapacity)
+	: pipeline(aPipeline),
+	  index(aIndex),
+	  workers(aWorkers),
+	  capacity(aCapacity),
+	  startTime(std::chrono::steady_clock::now())
+	{
+		for(unsigned int i = 0; i < workers; ++i) {
+			threads.emplace_back([this]() {
+				run();
+			});
+		}
+	}
+
+	/* Items that are queued already are processed before the workers stop */
+	~Stage() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+		}
+		notEmptyCV.notify_all();
+
+		for(auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	/* blocks as long as the queue is full */
+	void push(Item& item) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notFullCV.wait(lock, [this]() {
+			return queue.size() < capacity;
+		});
+
+		item.enqueued = std::chrono::steady_clock::now();
+		queue.push_back(&item);
+		maxDepth = std::max(maxDepth, queue.size());
+
+		lock.unlock();
+		notEmptyCV.notify_one();
+	}
+
+	void report(std::ostream& oStream) const {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - startTime;
+		double utilization = elapsed.count() > 0 ? 100.0 * static_cast<double>(serviceTime.count()) / (static_cast<double>(elapsed.count()) * workers) : 0.0;
+
+		std::ostringstream line;
+		line << "Stage " << (index + 1)
+				<< ": workers " << workers
+				<< ", queue " << queue.size() << "/" << capacity << " (max " << maxDepth << ")"
+				<< ", processed " << processed
+				<< ", failed " << failed
+				<< ", utilization " << std::fixed << std::setprecision(1) << utilization << "%"
+				<< ", service avg " << std::setprecision(3) << (processed > 0 ? toMilliseconds(serviceTime) / processed : 0.0) << " ms"
+				<< ", max " << toMilliseconds(maxServiceTime) << " ms"
+				<< ", wait avg " << (processed > 0 ? toMilliseconds(waitTime) / processed : 0.0) << " ms\n";
+		oStream << line.str();
+	}
+
+private:
+	Pipeline& pipeline;
+	const std::size_t index;
+	const unsigned int workers;
+	const std::size_t capacity;
+	const std::chrono::steady_clock::time_point startTime;
+
+	mutable std::mutex mutex;
+	std::condition_variable notEmptyCV;
+	std::condition_variable notFullCV;
+	std::deque<Item*> queue;
+	bool stopped = false;
+	std::vector<std::thread> threads;
+
+	std::size_t maxDepth = 0;
+	std::uint64_t processed = 0;
+	std::uint64_t failed = 0;
+	std::chrono::nanoseconds serviceTime { 0 };
+	std::chrono::nanoseconds maxServiceTime { 0 };
+	std::chrono::nanoseconds waitTime { 0 };
+
+	void run() {
+		while(true) {
+			Item* item;
+			std::chrono::steady_clock::time_point beginTime;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				notEmptyCV.wait(lock, [this]() {
+					return stopped || !queue.empty();
+				});
+				if(queue.empty()) {
+					return;
+				}
+
+				item = queue.front();
+				queue.pop_front();
+
+				beginTime = std::chrono::steady_clock::now();
+				waitTime += beginTime - item->enqueued;
+			}
+			notFullCV.notify_one();
+
+			std::exception_ptr exceptionPtr;
+			try {
+				item->call.procedureRun(index, item->context);
+			}
+			catch(...) {
+				exceptionPtr = std::current_exception();
+			}
+
+			std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - beginTime;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				++processed;
+				serviceTime += duration;
+				maxServiceTime = std::max(maxServiceTime, duration);
+				if(exceptionPtr) {
+					++failed;
+				}
+			}
+
+			bool next = true;
+			if(exceptionPtr) {
+				try {
+					next = !pipeline.onEntryException(item->context, exceptionPtr);
+				}
+				catch(...) {
+					item->exception = std::current_exception();
+					next = false;
+				}
+			}
+
+			if(next && index + 1 < item->call.getEntryCount()) {
+				pipeline.getStage(index + 1).push(*item);
+			}
+			else {
+				std::lock_guard<std::mutex> lock(item->mutex);
+				item->done = true;
+				item->doneCV.notify_one();
+			}
+		}
+	}
+};
+
+std::unique_ptr<esl::boot::context::Context> Pipeline::create(const std::vector<std::pair<std::string, std::string>>& settings) {
+	return std::unique_ptr<esl::boot::context::Context>(new Pipeline(settings));
+}
+
+Pipeline::Pipeline(const std::vector<std::pair<std::string, std::string>>& settings)
+: Context(getContextSettings(settings))
+{
+	for(const auto& setting : settings) {
+		if(setting.first == "workers") {
+			if(workers > 0) {
+				throw std::runtime_error("multiple definition of attribute 'workers'.");
+			}
+			workers = toWorkers(setting.second, "workers");
+		}
+		else if(setting.first == "stage-workers") {
+			/* "<stage>:<workers>" - stages are numbered from 1 like the entries */
+			std::string::size_type colonPos = setting.second.find(':');
+			if(colonPos == std::string::npos) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'stage-workers'. Value must be '<stage>:<workers>'");
+			}
+
+			std::size_t stage = 0;
+			try {
+				stage = static_cast<std::size_t>(std::stoul(setting.second.substr(0, colonPos)));
+			}
+			catch(...) {
+			}
+			if(stage == 0) {
+				throw std::runtime_error("Invalid stage number in value \"" + setting.second + "\" for attribute 'stage-workers'. Stages are numbered from 1.");
+			}
+
+			stageWorkers.emplace_back(stage - 1, toWorkers(setting.second.substr(colonPos + 1), "stage-workers"));
+		}
+		else if(setting.first == "queue-size") {
+			if(queueSize > 0) {
+				throw std::runtime_error("multiple definition of attribute 'queue-size'.");
+			}
+
+			long tmpQueueSize;
+			try {
+				tmpQueueSize = std::stol(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'queue-size'.");
+			}
+			if(tmpQueueSize <= 0) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'queue-size'. Value has to be greater than 0.");
+			}
+			queueSize = static_cast<std::size_t>(tmpQueueSize);
+		}
+		else if(setting.first == "show-metrics") {
+			if(hasOutput) {
+				throw std::runtime_error("multiple definition of attribute 'show-metrics'.");
+			}
+			hasOutput = true;
+
+			if(setting.second == "stdout") {
+				output = stdOut;
+			}
+			else if(setting.second == "stderr") {
+				output = stdErr;
+			}
+			else if(setting.second == "trace") {
+				output = logTrace;
+			}
+			else if(setting.second == "debug") {
+				output = logDebug;
+			}
+			else if(setting.second == "info") {
+				output = logInfo;
+			}
+			else if(setting.second == "warn") {
+				output = logWarn;
+			}
+			else if(setting.second == "error") {
+				output = logError;
+			}
+			else {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'show-metrics'");
+			}
+		}
+		else if(setting.first == "metrics-interval-ms") {
+			if(metricsInterval.count() > 0) {
+				throw std::runtime_error("multiple definition of attribute 'metrics-interval-ms'.");
+			}
+
+			long interval;
+			try {
+				interval = std::stol(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'metrics-interval-ms'.");
+			}
+			if(interval <= 0) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'metrics-interval-ms'. Value has to be greater than 0.");
+			}
+			metricsInterval = std::chrono::milliseconds(interval);
+		}
+	}
+
+	if(workers == 0) {
+		workers = 1;
+	}
+	if(queueSize == 0) {
+		queueSize = 64;
+	}
+
+	if(metricsInterval.count() > 0) {
+		if(!hasOutput) {
+			logger.warn << "Definition of 'metrics-interval-ms' is useless without definition of 'show-metrics'";
+		}
+		else {
+			reporter = std::thread([this]() {
+				std::unique_lock<std::mutex> lock(reporterMutex);
+				while(!reporterCV.wait_for(lock, metricsInterval, [this]() { return reporterStopped; })) {
+					printReport();
+				}
+			});
+		}
+	}
+}
+
+Pipeline::~Pipeline() {
+	if(reporter.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(reporterMutex);
+			reporterStopped = true;
+		}
+		reporterCV.notify_all();
+		reporter.join();
+	}
+
+	if(hasOutput) {
+		printReport();
+	}
+
+	/* A stage drains its queue into the next stage, so stages are stopped from first to last.
+	 * The stages stay in place, so the draining workers push into the next stage that is stopped
+	 * afterwards. The lock is not held while a stage stops, because its workers call getStage. */
+	for(std::size_t index = 0; ; ++index) {
+		std::unique_ptr<Stage> stage;
+		{
+			std::lock_guard<std::mutex> lock(stagesMutex);
+			if(index >= stages.size()) {
+				break;
+			}
+			stage = std::move(stages[index]);
+		}
+		stage.reset();
+	}
+}
+
+void Pipeline::procedureRun(esl::object::Context& context) {
+	Call call(*this);
+	if(call.getEntryCount() == 0) {
+		return;
+	}
+
+	Item item(context, call);
+	getStage(0).push(item);
+
+	std::unique_lock<std::mutex> lock(item.mutex);
+	item.doneCV.wait(lock, [&item]() {
+		return item.done;
+	});
+
+	if(item.exception) {
+		std::rethrow_exception(item.exception);
+	}
+}
+
+void Pipeline::report(std::ostream& oStream) const {
+	std::lock_guard<std::mutex> lock(stagesMutex);
+
+	oStream << "Pipeline:\n";
+	for(const auto& stage : stages) {
+		/* empty for stages that have been stopped already */
+		if(stage) {
+			stage->report(oStream);
+		}
+	}
+}
+
+/* Stages are created on first use, because the number of entries is known after the configuration has been added */
+Pipeline::Stage& Pipeline::getStage(std::size_t index) {
+	std::lock_guard<std::mutex> lock(stagesMutex);
+
+	while(stages.size() <= index) {
+		unsigned int stageWorkerCount = workers;
+		for(const auto& stageWorker : stageWorkers) {
+			if(stageWorker.first == stages.size()) {
+				stageWorkerCount = stageWorker.second;
+			}
+		}
+		stages.emplace_back(new Stage(*this, stages.size(), stageWorkerCount, queueSize));
+	}
+
+	return *stages[index];
+}
+
+void Pipeline::printReport() {
+	switch(output) {
+	case stdOut:
+		report(std::cout);
+		break;
+	case stdErr:
+		report(std::cerr);
+		break;
+	default: {
+		std::stringstream strStream;
+		report(strStream);
+		if(output == logTrace) {
+			logger.trace << strStream.str();
+		}
+		else if(output == logDebug) {
+			logger.debug << strStream.str();
+		}
+		else if(output == logInfo) {
+			logger.info << strStream.str();
+		}
+		else if(output == logWarn) {
+			logger.warn << strStream.str();
+		}
+		else {
+			logger.error << strStream.str();
+		}
+		break;
+	}
+	}
+}
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
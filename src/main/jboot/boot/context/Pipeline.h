@@ -0,0 +1,96 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_BOOT_CONTEXT_PIPELINE_H_
+#define JBOOT_BOOT_CONTEXT_PIPELINE_H_
+
+#include <jboot/boot/context/Context.h>
+
+#include <esl/boot/context/Context.h>
+#include <esl/object/Context.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+/* Boot context that runs its entries as stages of a pipeline (SEDA). Every stage has its own worker
+ * threads and a bounded queue. procedureRun puts the context into the queue of the first stage and
+ * returns when it has passed all stages, so the contexts of concurrent callers are processed by all
+ * stages at the same time. A full queue blocks the stage before, down to the callers. */
+class Pipeline : public Context {
+public:
+	static std::unique_ptr<esl::boot::context::Context> create(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	Pipeline(const std::vector<std::pair<std::string, std::string>>& settings);
+	~Pipeline();
+
+	void procedureRun(esl::object::Context& context) override;
+
+	/* queue depth, utilization and service time of every stage */
+	void report(std::ostream& oStream) const;
+
+private:
+	class Stage;
+	struct Item;
+
+	unsigned int workers = 0;
+	/* pairs of stage index and number of workers, 0-based */
+	std::vector<std::pair<std::size_t, unsigned int>> stageWorkers;
+	std::size_t queueSize = 0;
+
+	enum Output {
+		stdOut,
+		stdErr,
+		logTrace,
+		logDebug,
+		logInfo,
+		logWarn,
+		logError
+	};
+	bool hasOutput = false;
+	Output output = stdOut;
+	std::chrono::milliseconds metricsInterval { 0 };
+
+	mutable std::mutex stagesMutex;
+	std::vector<std::unique_ptr<Stage>> stages;
+
+	std::mutex reporterMutex;
+	std::condition_variable reporterCV;
+	bool reporterStopped = false;
+	std::thread reporter;
+
+	Stage& getStage(std::size_t index);
+	void printReport();
+};
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
+
+#endif /* JBOOT_BOOT_CONTEXT_PIPELINE_H_ */
@@ -0,0 +1,567 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/boot/context/Prefork.h>
+#include <jboot/Logger.h>
+
+#include <esl/system/Stacktrace.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+namespace {
+Logger logger("jboot::boot::context::Prefork");
+
+const std::set<std::string> preforkAttributes {
+	"processes",
+	"restart",
+	"restart-delay-ms",
+	"stop-timeout-ms",
+	"zygote-max-processes",
+	"zygote-socket"
+};
+
+std::vector<std::pair<std::string, std::string>> getContextSettings(const std::vector<std::pair<std::string, std::string>>& settings) {
+	std::vector<std::pair<std::string, std::string>> contextSettings;
+
+	for(const auto& setting : settings) {
+		if(preforkAttributes.count(setting.first) == 0) {
+			contextSettings.push_back(setting);
+		}
+	}
+
+	return contextSettings;
+}
+
+volatile std::sig_atomic_t receivedSignal = 0;
+
+void onSignal(int signal) {
+	receivedSignal = signal;
+}
+
+/* installs the forwarding handler for SIGTERM and SIGINT while the supervisor is running */
+class SignalHandlers {
+public:
+	SignalHandlers() {
+		receivedSignal = 0;
+
+		struct sigaction action;
+		std::memset(&action, 0, sizeof(action));
+		action.sa_handler = onSignal;
+		sigemptyset(&action.sa_mask);
+
+		::sigaction(SIGTERM, &action, &oldTerm);
+		::sigaction(SIGINT, &action, &oldInt);
+	}
+
+	~SignalHandlers() {
+		restore();
+	}
+
+	/* called in the worker process as well, so it handles signals like the parent did before */
+	void restore() {
+		::sigaction(SIGTERM, &oldTerm, nullptr);
+		::sigaction(SIGINT, &oldInt, nullptr);
+	}
+
+private:
+	struct sigaction oldTerm;
+	struct sigaction oldInt;
+};
+
+SignalHandlers* signalHandlers = nullptr;
+
+std::string toString(int status) {
+	if(WIFEXITED(status)) {
+		return "exit code " + std::to_string(WEXITSTATUS(status));
+	}
+	if(WIFSIGNALED(status)) {
+		return "signal " + std::to_string(WTERMSIG(status));
+	}
+	return "status " + std::to_string(status);
+}
+} /* anonymous namespace */
+
+std::unique_ptr<esl::boot::context::Context> Prefork::create(const std::vector<std::pair<std::string, std::string>>& settings) {
+	return std::unique_ptr<esl::boot::context::Context>(new Prefork(settings));
+}
+
+Prefork::Prefork(const std::vector<std::pair<std::string, std::string>>& settings)
+: Context(getContextSettings(settings))
+{
+	for(const auto& setting : settings) {
+		if(setting.first == "processes") {
+			if(hasProcesses) {
+				throw std::runtime_error("multiple definition of attribute 'processes'.");
+			}
+			hasProcesses = true;
+
+			long tmpProcesses;
+			try {
+				tmpProcesses = std::stol(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'processes'.");
+			}
+			if(tmpProcesses < 0 || tmpProcesses > 1000) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'processes'. Value has to be between 0 and 1000.");
+			}
+			processes = static_cast<unsigned int>(tmpProcesses);
+		}
+		else if(setting.first == "restart") {
+			if(hasRestart) {
+				throw std::runtime_error("multiple definition of attribute 'restart'.");
+			}
+			hasRestart = true;
+
+			if(setting.second == "true") {
+				restart = true;
+			}
+			else if(setting.second == "false") {
+				restart = false;
+			}
+			else {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'restart'");
+			}
+		}
+		else if(setting.first == "restart-delay-ms") {
+			if(hasRestartDelay) {
+				throw std::runtime_error("multiple definition of attribute 'restart-delay-ms'.");
+			}
+			hasRestartDelay = true;
+
+			long ms;
+			try {
+				ms = std::stol(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'restart-delay-ms'.");
+			}
+			if(ms < 0) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'restart-delay-ms'. Value must be >= 0");
+			}
+			restartDelay = std::chrono::milliseconds(ms);
+		}
+		else if(setting.first == "stop-timeout-ms") {
+			if(hasStopTimeout) {
+				throw std::runtime_error("multiple definition of attribute 'stop-timeout-ms'.");
+			}
+			hasStopTimeout = true;
+
+			long ms;
+			try {
+				ms = std::stol(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'stop-timeout-ms'.");
+			}
+			if(ms < 0) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'stop-timeout-ms'. Value must be >= 0");
+			}
+			stopTimeout = std::chrono::milliseconds(ms);
+		}
+		else if(setting.first == "zygote-max-processes") {
+			if(hasZygoteMaxProcesses) {
+				throw std::runtime_error("multiple definition of attribute 'zygote-max-processes'.");
+			}
+			hasZygoteMaxProcesses = true;
+
+			int tmpProcesses;
+			try {
+				tmpProcesses = std::stoi(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'zygote-max-processes'.");
+			}
+			if(tmpProcesses <= 0 || tmpProcesses > 1000) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'zygote-max-processes'. Value has to be between 1 and 1000.");
+			}
+			zygoteMaxProcesses = static_cast<unsigned int>(tmpProcesses);
+		}
+		else if(setting.first == "zygote-socket") {
+			if(!zygoteSocket.empty()) {
+				throw std::runtime_error("multiple definition of attribute 'zygote-socket'.");
+			}
+			zygoteSocket = setting.second;
+			if(zygoteSocket.empty()) {
+				throw std::runtime_error("Invalid value \"\" for attribute 'zygote-socket'.");
+			}
+			if(zygoteSocket.size() >= sizeof(sockaddr_un::sun_path)) {
+				throw std::runtime_error("Invalid value \"" + zygoteSocket + "\" for attribute 'zygote-socket'. Path is too long.");
+			}
+		}
+	}
+
+	if(!hasProcesses && zygoteSocket.empty()) {
+		processes = std::thread::hardware_concurrency();
+		if(processes == 0) {
+			processes = 1;
+		}
+	}
+	if(processes == 0 && zygoteSocket.empty()) {
+		throw std::runtime_error("Invalid value \"0\" for attribute 'processes'. Value 0 is only allowed together with attribute 'zygote-socket'.");
+	}
+	if(hasZygoteMaxProcesses && zygoteSocket.empty()) {
+		logger.warn << "Definition of 'zygote-max-processes' is useless without definition of 'zygote-socket'";
+	}
+}
+
+void Prefork::procedureRun(esl::object::Context& context) {
+	canceled.store(false);
+
+	SignalHandlers handlers;
+	signalHandlers = &handlers;
+
+	if(!zygoteSocket.empty()) {
+		listenFd = openZygoteSocket();
+	}
+
+	std::vector<Worker> workers(processes);
+	for(std::size_t i = 0; i < workers.size(); ++i) {
+		workers[i].index = i;
+		workers[i].pid = startWorker(context, workers[i]);
+	}
+	nextWorkerIndex = processes;
+
+	bool stopping = false;
+	bool killed = false;
+	std::chrono::steady_clock::time_point killTime;
+	for(bool running = true; running;) {
+		if(!stopping && (receivedSignal != 0 || canceled.load())) {
+			stopping = true;
+			killTime = std::chrono::steady_clock::now() + stopTimeout;
+			logger.info << "Stopping " << workers.size() << " worker processes.\n";
+			for(auto& worker : workers) {
+				if(worker.pid > 0) {
+					::kill(worker.pid, SIGTERM);
+				}
+			}
+			if(listenFd >= 0) {
+				::close(listenFd);
+				listenFd = -1;
+				::unlink(zygoteSocket.c_str());
+			}
+		}
+		else if(stopping && !killed && std::chrono::steady_clock::now() >= killTime) {
+			/* workers that ignore or block SIGTERM must not keep the supervisor alive */
+			killed = true;
+			for(std::size_t i = 0; i < workers.size(); ++i) {
+				if(workers[i].pid > 0) {
+					logger.warn << "Worker process " << workers[i].index << " has not terminated " << stopTimeout.count() << " ms after SIGTERM. Sending SIGKILL.\n";
+					::kill(workers[i].pid, SIGKILL);
+				}
+			}
+		}
+
+		/* a zygote keeps running without workers until it gets canceled */
+		running = listenFd >= 0;
+		for(std::size_t i = 0; i < workers.size(); ++i) {
+			Worker& worker = workers[i];
+
+			if(worker.pid > 0) {
+				int status;
+				pid_t rv = ::waitpid(worker.pid, &status, WNOHANG);
+				if(rv == 0 || (rv < 0 && errno == EINTR)) {
+					running = true;
+					continue;
+				}
+
+				worker.pid = -1;
+				bool crashed = rv < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+				if(crashed && !stopping && restart) {
+					logger.warn << "Worker process " << worker.index << " terminated with " << (rv < 0 ? std::string(std::strerror(errno)) : toString(status)) << ". Restarting it.\n";
+					worker.restartTime = std::chrono::steady_clock::now() + restartDelay;
+				}
+				else {
+					if(crashed) {
+						logger.error << "Worker process " << worker.index << " terminated with " << (rv < 0 ? std::string(std::strerror(errno)) : toString(status)) << ".\n";
+					}
+					worker.finished = true;
+				}
+			}
+
+			if(worker.finished) {
+				continue;
+			}
+			if(stopping) {
+				worker.finished = true;
+				continue;
+			}
+
+			running = true;
+			if(std::chrono::steady_clock::now() >= worker.restartTime) {
+				try {
+					worker.pid = startWorker(context, worker);
+				}
+				catch(const std::exception& e) {
+					logger.error << e.what() << "\n";
+					worker.restartTime = std::chrono::steady_clock::now() + restartDelay;
+				}
+			}
+		}
+
+		/* workers forked on request are not restarted after they have finished, so they are removed */
+		workers.erase(std::remove_if(workers.begin() + std::min<std::size_t>(processes, workers.size()), workers.end(), [](const Worker& worker) {
+			return worker.finished;
+		}), workers.end());
+
+		if(!running) {
+			break;
+		}
+		if(listenFd >= 0) {
+			acceptRequests(context, workers);
+		}
+		else {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+
+	signalHandlers = nullptr;
+}
+
+void Prefork::procedureCancel() {
+	canceled.store(true);
+}
+
+pid_t Prefork::startWorker(esl::object::Context& context, const Worker& worker) {
+	/* flush buffered output, otherwise it is written by parent and worker */
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+
+	pid_t pid = ::fork();
+	if(pid < 0) {
+		throw esl::system::Stacktrace::add(std::runtime_error(std::string("Cannot fork worker process: ") + std::strerror(errno)));
+	}
+	if(pid == 0) {
+		runWorker(context, worker);
+	}
+
+	logger.debug << "Started worker process " << worker.index << " with pid " << pid << ".\n";
+	return pid;
+}
+
+void Prefork::runWorker(esl::object::Context& context, const Worker& worker) noexcept {
+	const std::size_t index = worker.index;
+
+	if(signalHandlers) {
+		signalHandlers->restore();
+	}
+	if(listenFd >= 0) {
+		::close(listenFd);
+		listenFd = -1;
+	}
+	/* otherwise the client of the fork request would not see the end of the connection until the worker exits */
+	if(requestFd >= 0) {
+		::close(requestFd);
+		requestFd = -1;
+	}
+
+	::setenv("JBOOT_WORKER_INDEX", std::to_string(index).c_str(), 1);
+	::setenv("JBOOT_WORKER_COUNT", std::to_string(std::max<std::size_t>(index + 1, processes)).c_str(), 1);
+	for(const auto& variable : worker.environment) {
+		::setenv(variable.first.c_str(), variable.second.c_str(), 1);
+	}
+
+	int rc;
+	try {
+		Context::procedureRun(context);
+		rc = getReturnCode();
+	}
+	catch(const std::exception& e) {
+		logger.error << "Worker process " << index << " failed: " << e.what() << "\n";
+		rc = 1;
+	}
+	catch(...) {
+		logger.error << "Worker process " << index << " failed with unknown exception.\n";
+		rc = 1;
+	}
+
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+	::_exit(rc);
+}
+
+int Prefork::openZygoteSocket() {
+	int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if(fd < 0) {
+		throw esl::system::Stacktrace::add(std::runtime_error(std::string("Cannot create zygote socket: ") + std::strerror(errno)));
+	}
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, zygoteSocket.c_str(), sizeof(address.sun_path) - 1);
+
+	/* remove the socket file of a previous run */
+	::unlink(zygoteSocket.c_str());
+
+	/* Only the owner may request workers. The socket file is created without access for others,
+	 * so there is no moment in which another user can connect. */
+	mode_t mask = ::umask(0177);
+	int rv = ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+	::umask(mask);
+	if(rv != 0 || ::chmod(zygoteSocket.c_str(), 0600) != 0 || ::listen(fd, 16) != 0) {
+		int errorNo = errno;
+		::close(fd);
+		throw esl::system::Stacktrace::add(std::runtime_error("Cannot listen on zygote socket \"" + zygoteSocket + "\": " + std::strerror(errorNo)));
+	}
+
+	logger.info << "Zygote is waiting for requests on \"" << zygoteSocket << "\".\n";
+	return fd;
+}
+
+void Prefork::acceptRequests(esl::object::Context& context, std::vector<Worker>& workers) {
+	pollfd pollFd;
+	pollFd.fd = listenFd;
+	pollFd.events = POLLIN;
+	pollFd.revents = 0;
+	if(::poll(&pollFd, 1, 100) <= 0) {
+		return;
+	}
+
+	for(;;) {
+		int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+		if(fd < 0) {
+			return;
+		}
+
+		/* the permissions of the socket file might have been changed afterwards */
+		ucred credentials;
+		socklen_t credentialsSize = sizeof(credentials);
+		if(::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &credentialsSize) != 0 || (credentials.uid != ::geteuid() && credentials.uid != 0)) {
+			logger.warn << "Rejecting request on zygote socket from process " << credentials.pid << " of another user.\n";
+			::close(fd);
+			continue;
+		}
+
+		/* a client that does not send its request in time must not block the supervisor */
+		const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+		std::string request;
+		while(request.size() < 4096 && request.find('\n') == std::string::npos) {
+			std::chrono::milliseconds remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+			if(remaining.count() <= 0) {
+				break;
+			}
+
+			pollfd requestPollFd;
+			requestPollFd.fd = fd;
+			requestPollFd.events = POLLIN;
+			requestPollFd.revents = 0;
+			if(::poll(&requestPollFd, 1, static_cast<int>(remaining.count())) <= 0) {
+				continue;
+			}
+
+			char buffer[512];
+			ssize_t count = ::recv(fd, buffer, std::min(sizeof(buffer), 4096 - request.size()), MSG_DONTWAIT);
+			if(count <= 0) {
+				if(count < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+					continue;
+				}
+				break;
+			}
+			request.append(buffer, static_cast<std::size_t>(count));
+		}
+		request = request.substr(0, request.find('\n'));
+
+		requestFd = fd;
+		std::string response = handleRequest(context, workers, request) + "\n";
+		::send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+		::close(fd);
+		requestFd = -1;
+	}
+}
+
+std::string Prefork::handleRequest(esl::object::Context& context, std::vector<Worker>& workers, const std::string& request) {
+	std::istringstream iStream(request);
+	std::string command;
+	iStream >> command;
+
+	if(command == "workers") {
+		std::size_t count = 0;
+		for(const auto& worker : workers) {
+			if(!worker.finished) {
+				++count;
+			}
+		}
+		return std::to_string(count);
+	}
+
+	if(command != "fork") {
+		return "error unknown request \"" + command + "\"";
+	}
+
+	std::size_t requestedWorkers = 0;
+	for(std::size_t i = std::min<std::size_t>(processes, workers.size()); i < workers.size(); ++i) {
+		if(!workers[i].finished) {
+			++requestedWorkers;
+		}
+	}
+	if(requestedWorkers >= zygoteMaxProcesses) {
+		return "error too many workers, " + std::to_string(requestedWorkers) + " workers forked on request are running";
+	}
+
+	Worker worker;
+	worker.index = nextWorkerIndex;
+	for(std::string variable; iStream >> variable;) {
+		std::string::size_type equalPos = variable.find('=');
+		if(equalPos == std::string::npos || equalPos == 0) {
+			return "error invalid environment variable \"" + variable + "\"";
+		}
+		worker.environment.emplace_back(variable.substr(0, equalPos), variable.substr(equalPos + 1));
+	}
+
+	workers.push_back(std::move(worker));
+	try {
+		workers.back().pid = startWorker(context, workers.back());
+		++nextWorkerIndex;
+	}
+	catch(const std::exception& e) {
+		workers.pop_back();
+		return std::string("error ") + e.what();
+	}
+
+	return std::to_string(workers.back().pid);
+}
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
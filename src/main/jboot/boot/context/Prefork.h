@@ -0,0 +1,108 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_BOOT_CONTEXT_PREFORK_H_
+#define JBOOT_BOOT_CONTEXT_PREFORK_H_
+
+#include <jboot/boot/context/Context.h>
+
+#include <esl/boot/context/Context.h>
+#include <esl/object/Context.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+/* Boot context that forks worker processes after the configuration has been loaded.
+ * Every worker runs the entries independently with its own copy of all objects, so read-only
+ * memory like the configuration and loaded libraries is shared copy-on-write. The number of the
+ * worker is available in the environment variables JBOOT_WORKER_INDEX (0-based) and
+ * JBOOT_WORKER_COUNT. Server plugins that should accept connections in every worker have to
+ * bind their sockets with SO_REUSEPORT.
+ * The parent process supervises the workers: it restarts workers that crashed and forwards
+ * SIGTERM and SIGINT. Workers that have not terminated 'stop-timeout-ms' after SIGTERM get SIGKILL.
+ * procedureRun returns when all workers have terminated.
+ * With 'zygote-socket' the parent additionally serves requests on a unix socket to fork further
+ * workers, which start within milliseconds because everything is loaded already. A request is
+ * a line "fork [NAME=VALUE]..." with environment variables for the new worker and is answered
+ * by "<pid>" or "error <message>". The request "workers" is answered by the number of workers.
+ * Only processes of the same user or root can send requests and at most 'zygote-max-processes'
+ * (default 100) workers forked on request run at the same time.
+ * Without zygote-socket procedureRun returns when all workers have terminated, otherwise it
+ * returns after it has been canceled.
+ * Objects must not start threads before the workers are forked, because threads are not forked. */
+class Prefork : public Context {
+public:
+	static std::unique_ptr<esl::boot::context::Context> create(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	Prefork(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	void procedureRun(esl::object::Context& context) override;
+	void procedureCancel() override;
+
+private:
+	struct Worker {
+		/* JBOOT_WORKER_INDEX, workers forked on request get indices from 'processes' on */
+		std::size_t index = 0;
+		std::vector<std::pair<std::string, std::string>> environment;
+		pid_t pid = -1;
+		bool finished = false;
+		std::chrono::steady_clock::time_point restartTime;
+	};
+
+	bool hasProcesses = false;
+	unsigned int processes = 0;
+	bool hasRestart = false;
+	bool restart = true;
+	bool hasRestartDelay = false;
+	std::chrono::milliseconds restartDelay { 1000 };
+	bool hasStopTimeout = false;
+	std::chrono::milliseconds stopTimeout { 10000 };
+	std::string zygoteSocket;
+	bool hasZygoteMaxProcesses = false;
+	unsigned int zygoteMaxProcesses = 100;
+
+	std::atomic<bool> canceled { false };
+	int listenFd = -1;
+	/* connection of the request that is handled while a worker gets forked, closed in the worker */
+	int requestFd = -1;
+	std::size_t nextWorkerIndex = 0;
+
+	pid_t startWorker(esl::object::Context& context, const Worker& worker);
+	[[noreturn]] void runWorker(esl::object::Context& context, const Worker& worker) noexcept;
+
+	int openZygoteSocket();
+	void acceptRequests(esl::object::Context& context, std::vector<Worker>& workers);
+	std::string handleRequest(esl::object::Context& context, std::vector<Worker>& workers, const std::string& request);
+};
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
+
+#endif /* JBOOT_BOOT_CONTEXT_PREFORK_H_ */
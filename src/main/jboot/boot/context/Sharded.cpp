@@ -0,0 +1,397 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/boot/context/Sharded.h>
+#include <jboot/Logger.h>
+
+#include <esl/object/Value.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+namespace {
+Logger logger("jboot::boot::context::Sharded");
+
+const std::set<std::string> shardedAttributes {
+	"shards",
+	"shard-key",
+	"pin-threads"
+};
+
+std::vector<std::pair<std::string, std::string>> getContextSettings(const std::vector<std::pair<std::string, std::string>>& settings) {
+	std::vector<std::pair<std::string, std::string>> contextSettings;
+
+	for(const auto& setting : settings) {
+		if(shardedAttributes.count(setting.first) == 0) {
+			contextSettings.push_back(setting);
+		}
+	}
+
+	return contextSettings;
+}
+
+/* cores the process is allowed to run on, e.g. restricted by taskset or a cgroup */
+std::vector<int> getCpus() {
+	std::vector<int> cpus;
+
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	if(sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0) {
+		for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if(CPU_ISSET(cpu, &cpuSet)) {
+				cpus.push_back(cpu);
+			}
+		}
+	}
+
+	return cpus;
+}
+} /* anonymous namespace */
+
+struct Sharded::Task {
+	Task(std::function<void(Context&)> aFunction)
+	: function(std::move(aFunction))
+	{ }
+
+	void execute(Context& context) {
+		try {
+			function(context);
+		}
+		catch(...) {
+			exception = std::current_exception();
+		}
+
+		/* notified under the lock, because the task is destroyed as soon as the waiting thread sees 'done' */
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+		doneCV.notify_one();
+	}
+
+	void wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		doneCV.wait(lock, [this]() {
+			return done;
+		});
+	}
+
+	std::function<void(Context&)> function;
+
+	std::mutex mutex;
+	std::condition_variable doneCV;
+	bool done = false;
+	std::exception_ptr exception;
+};
+
+class Sharded::Shard {
+public:
+	Shard(Sharded& sharded, std::size_t aIndex, int aCpu)
+	: index(aIndex),
+	  cpu(aCpu),
+	  context(new Context(std::vector<std::pair<std::string, std::string>>()))
+	{
+		context->setParent(&sharded);
+
+		thread = std::thread([this]() {
+			run();
+		});
+	}
+
+	/* Tasks that are queued already are executed before the thread stops */
+	~Shard() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+		}
+		notEmptyCV.notify_one();
+
+		thread.join();
+	}
+
+	/* A task that is posted by the thread of this shard is executed directly, otherwise it would wait for itself */
+	void post(Task& task) {
+		if(currentShard == this) {
+			task.execute(*context);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.push_back(&task);
+		}
+		notEmptyCV.notify_one();
+	}
+
+	const Context& getContext() const noexcept {
+		return *context;
+	}
+
+private:
+	static thread_local Shard* currentShard;
+
+	const std::size_t index;
+	const int cpu;
+	std::unique_ptr<Context> context;
+
+	std::mutex mutex;
+	std::condition_variable notEmptyCV;
+	std::deque<Task*> queue;
+	bool stopped = false;
+	std::thread thread;
+
+	void run() {
+		currentShard = this;
+
+		if(cpu >= 0) {
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(cpu, &cpuSet);
+
+			int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+			if(rc != 0) {
+				logger.warn << "Cannot pin thread of shard " << (index + 1) << " to cpu " << cpu << ": " << std::strerror(rc) << "\n";
+			}
+		}
+
+		while(true) {
+			Task* task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				notEmptyCV.wait(lock, [this]() {
+					return stopped || !queue.empty();
+				});
+				if(queue.empty()) {
+					break;
+				}
+
+				task = queue.front();
+				queue.pop_front();
+			}
+
+			task->execute(*context);
+		}
+
+		/* the objects of the shard are destroyed by the thread that has used them */
+		context.reset();
+	}
+};
+
+thread_local Sharded::Shard* Sharded::Shard::currentShard = nullptr;
+
+std::unique_ptr<esl::boot::context::Context> Sharded::create(const std::vector<std::pair<std::string, std::string>>& settings) {
+	return std::unique_ptr<esl::boot::context::Context>(new Sharded(settings));
+}
+
+Sharded::Sharded(const std::vector<std::pair<std::string, std::string>>& settings)
+: Context(getContextSettings(settings))
+{
+	for(const auto& setting : settings) {
+		if(setting.first == "shards") {
+			if(shardCount > 0) {
+				throw std::runtime_error("multiple definition of attribute 'shards'.");
+			}
+
+			long tmpShardCount;
+			try {
+				tmpShardCount = std::stol(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'shards'.");
+			}
+			if(tmpShardCount <= 0 || tmpShardCount > 1024) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'shards'. Value has to be between 1 and 1024.");
+			}
+			shardCount = static_cast<std::size_t>(tmpShardCount);
+		}
+		else if(setting.first == "shard-key") {
+			if(!shardKeyId.empty()) {
+				throw std::runtime_error("multiple definition of attribute 'shard-key'.");
+			}
+			shardKeyId = setting.second;
+			if(shardKeyId.empty()) {
+				throw std::runtime_error("Invalid value \"\" for attribute 'shard-key'.");
+			}
+		}
+		else if(setting.first == "pin-threads") {
+			if(hasPinThreads) {
+				throw std::runtime_error("multiple definition of attribute 'pin-threads'.");
+			}
+			hasPinThreads = true;
+
+			if(setting.second == "true") {
+				pinThreads = true;
+			}
+			else if(setting.second == "false") {
+				pinThreads = false;
+			}
+			else {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'pin-threads'");
+			}
+		}
+	}
+
+	std::vector<int> cpus = getCpus();
+
+	if(shardCount == 0) {
+		shardCount = cpus.empty() ? std::thread::hardware_concurrency() : cpus.size();
+		if(shardCount == 0) {
+			shardCount = 1;
+		}
+	}
+	if(pinThreads && cpus.empty()) {
+		logger.warn << "Threads of the shards are not pinned, because the cpus of the process are unknown.\n";
+	}
+	else if(pinThreads && shardCount > cpus.size()) {
+		logger.warn << "There are more shards (" << shardCount << ") than cpus (" << cpus.size() << "), so some cpus are shared by shards.\n";
+	}
+
+	for(std::size_t index = 0; index < shardCount; ++index) {
+		int cpu = pinThreads && !cpus.empty() ? cpus[index % cpus.size()] : -1;
+		shards.emplace_back(new Shard(*this, index, cpu));
+	}
+}
+
+/* Shards are destroyed before the context, because their contexts look up objects in this context */
+Sharded::~Sharded() {
+	shards.clear();
+}
+
+esl::boot::context::Context& Sharded::addData(const std::string& configuration) {
+	runEach([&configuration](Context& context) {
+		context.addData(configuration);
+	});
+
+	return *this;
+}
+
+esl::boot::context::Context& Sharded::addFile(const boost::filesystem::path& filename) {
+	runEach([&filename](Context& context) {
+		context.addFile(filename);
+	});
+
+	return *this;
+}
+
+int Sharded::getReturnCode() const {
+	for(const auto& shard : shards) {
+		int returnCode = shard->getContext().getReturnCode();
+		if(returnCode != 0) {
+			return returnCode;
+		}
+	}
+
+	return Context::getReturnCode();
+}
+
+void Sharded::onEvent(const esl::object::Object& object) {
+	runAll([&object](Context& context) {
+		context.onEvent(object);
+	});
+}
+
+void Sharded::onEvents(const esl::object::Object* const* objects, std::size_t count) {
+	runAll([objects, count](Context& context) {
+		context.onEvents(objects, count);
+	});
+}
+
+void Sharded::procedureRun(esl::object::Context& context) {
+	Task task([&context](Context& shardContext) {
+		shardContext.procedureRun(context);
+	});
+
+	shards[getShardIndex(context)]->post(task);
+	task.wait();
+
+	if(task.exception) {
+		onEntryException(context, task.exception);
+	}
+}
+
+void Sharded::initializeContext(esl::object::Context& context) {
+	Context::initializeContext(context);
+
+	/* every shard creates the objects of its configuration on its own core */
+	runAll([](Context& shardContext) {
+		shardContext.initializeContext(shardContext);
+	});
+}
+
+std::size_t Sharded::getShardCount() const noexcept {
+	return shards.size();
+}
+
+/* Requests with the same key are always processed by the same shard, requests without key are distributed round robin */
+std::size_t Sharded::getShardIndex(esl::object::Context& context) {
+	if(!shardKeyId.empty()) {
+		esl::object::Value<std::string>* key = context.findObject<esl::object::Value<std::string>>(shardKeyId);
+		if(key) {
+			return std::hash<std::string>()(**key) % shards.size();
+		}
+	}
+
+	return nextShard.fetch_add(1, std::memory_order_relaxed) % shards.size();
+}
+
+void Sharded::runAll(const std::function<void(Context&)>& function) {
+	std::vector<std::unique_ptr<Task>> tasks;
+	for(auto& shard : shards) {
+		tasks.emplace_back(new Task(function));
+		shard->post(*tasks.back());
+	}
+
+	std::exception_ptr exceptionPtr;
+	for(auto& task : tasks) {
+		task->wait();
+		if(task->exception && !exceptionPtr) {
+			exceptionPtr = task->exception;
+		}
+	}
+
+	if(exceptionPtr) {
+		std::rethrow_exception(exceptionPtr);
+	}
+}
+
+void Sharded::runEach(const std::function<void(Context&)>& function) {
+	for(auto& shard : shards) {
+		Task task(function);
+		shard->post(task);
+		task.wait();
+
+		if(task.exception) {
+			std::rethrow_exception(task.exception);
+		}
+	}
+}
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
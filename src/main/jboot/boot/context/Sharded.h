@@ -0,0 +1,91 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_BOOT_CONTEXT_SHARDED_H_
+#define JBOOT_BOOT_CONTEXT_SHARDED_H_
+
+#include <jboot/boot/context/Context.h>
+
+#include <esl/boot/context/Context.h>
+#include <esl/object/Context.h>
+#include <esl/object/Object.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+/* Boot context that installs the configuration of addFile and addData into one child context per
+ * shard. Every shard has its own copy of all objects and its own thread, that is pinned to a core,
+ * so the objects of a shard are only used by one thread. procedureRun is dispatched to a shard by
+ * the value of the object 'shard-key' in the context of the caller, events are delivered to all
+ * shards. Objects of the shards cannot be looked up from outside. */
+class Sharded : public Context {
+public:
+	static std::unique_ptr<esl::boot::context::Context> create(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	Sharded(const std::vector<std::pair<std::string, std::string>>& settings);
+	~Sharded();
+
+	esl::boot::context::Context& addData(const std::string& configuration) override;
+	esl::boot::context::Context& addFile(const boost::filesystem::path& filename) override;
+	int getReturnCode() const override;
+
+	void onEvent(const esl::object::Object& object) override;
+	void onEvents(const esl::object::Object* const* objects, std::size_t count) override;
+	void procedureRun(esl::object::Context& context) override;
+
+	void initializeContext(esl::object::Context& context) override;
+
+	std::size_t getShardCount() const noexcept;
+
+private:
+	class Shard;
+	struct Task;
+
+	std::size_t shardCount = 0;
+	std::string shardKeyId;
+	bool hasPinThreads = false;
+	bool pinThreads = true;
+
+	std::vector<std::unique_ptr<Shard>> shards;
+	std::atomic<std::size_t> nextShard { 0 };
+
+	std::size_t getShardIndex(esl::object::Context& context);
+
+	/* runs the function on the thread of every shard at the same time and rethrows the first exception */
+	void runAll(const std::function<void(Context&)>& function);
+
+	/* runs the function on the thread of one shard after the other, e.g. to load libraries only once */
+	void runEach(const std::function<void(Context&)>& function);
+};
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
+
+#endif /* JBOOT_BOOT_CONTEXT_SHARDED_H_ */
@@ -0,0 +1,221 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/boot/context/Timeline.h>
+
+#include <esl/system/Stacktrace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+namespace {
+struct Record {
+	std::string name;
+	std::string detail;
+	std::size_t threadId;
+	unsigned int depth;
+	std::chrono::nanoseconds begin;
+	std::chrono::nanoseconds wall;
+	std::chrono::nanoseconds cpu;
+	std::int64_t rssDelta;
+};
+
+std::atomic<bool> enabled { false };
+std::mutex recordsMutex;
+std::vector<Record> records;
+const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+thread_local unsigned int stepDepth = 0;
+
+std::chrono::nanoseconds getThreadCpuTime() {
+	struct timespec ts;
+	if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		return std::chrono::nanoseconds(0);
+	}
+	return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+std::int64_t getResidentSetSize() {
+	long pages = 0;
+	FILE* file = std::fopen("/proc/self/statm", "r");
+	if(file) {
+		if(std::fscanf(file, "%*s %ld", &pages) != 1) {
+			pages = 0;
+		}
+		std::fclose(file);
+	}
+	return static_cast<std::int64_t>(pages) * sysconf(_SC_PAGESIZE);
+}
+
+double toMs(std::chrono::nanoseconds duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+std::string escapeJSON(const std::string& str) {
+	std::string rv;
+	for(char c : str) {
+		switch(c) {
+		case '"':
+			rv += "\\\"";
+			break;
+		case '\\':
+			rv += "\\\\";
+			break;
+		case '\n':
+			rv += "\\n";
+			break;
+		default:
+			if(static_cast<unsigned char>(c) < 0x20) {
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				rv += buffer;
+			}
+			else {
+				rv += c;
+			}
+		}
+	}
+	return rv;
+}
+
+std::vector<Record> getRecords() {
+	std::vector<Record> rv;
+	{
+		std::lock_guard<std::mutex> lock(recordsMutex);
+		rv = records;
+	}
+	std::stable_sort(rv.begin(), rv.end(), [](const Record& a, const Record& b) {
+		return a.begin < b.begin;
+	});
+	return rv;
+}
+} /* anonymous namespace */
+
+Timeline::Step::Step(const char* aName, const std::string& aDetail)
+: enabled(Timeline::isEnabled()),
+  name(aName)
+{
+	if(!enabled) {
+		return;
+	}
+
+	detail = aDetail;
+	depth = stepDepth++;
+	rssBegin = getResidentSetSize();
+	cpuBegin = getThreadCpuTime();
+	wallBegin = std::chrono::steady_clock::now();
+}
+
+Timeline::Step::~Step() {
+	if(!enabled) {
+		return;
+	}
+
+	std::chrono::steady_clock::time_point wallEnd = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds cpuEnd = getThreadCpuTime();
+	std::int64_t rssEnd = getResidentSetSize();
+	--stepDepth;
+
+	Record record {
+		name,
+		std::move(detail),
+		std::hash<std::thread::id>()(std::this_thread::get_id()),
+		depth,
+		wallBegin - origin,
+		wallEnd - wallBegin,
+		cpuEnd - cpuBegin,
+		rssEnd - rssBegin
+	};
+
+	std::lock_guard<std::mutex> lock(recordsMutex);
+	records.push_back(std::move(record));
+}
+
+void Timeline::enable() {
+	enabled.store(true);
+}
+
+bool Timeline::isEnabled() noexcept {
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void Timeline::report(std::ostream& oStream) {
+	std::vector<Record> allRecords = getRecords();
+
+	oStream << "Boot timeline (" << allRecords.size() << " steps)\n";
+	oStream << "     start ms       wall ms        cpu ms     rss +KiB  step\n";
+	for(const auto& record : allRecords) {
+		oStream << std::fixed << std::setprecision(3)
+				<< std::setw(13) << toMs(record.begin)
+				<< std::setw(14) << toMs(record.wall)
+				<< std::setw(14) << toMs(record.cpu)
+				<< std::setw(13) << (record.rssDelta / 1024)
+				<< "  " << std::string(2 * record.depth, ' ') << record.name;
+		if(!record.detail.empty()) {
+			oStream << " " << record.detail;
+		}
+		oStream << "\n";
+	}
+	oStream << std::defaultfloat;
+}
+
+void Timeline::writeChromeTrace(const std::string& fileName) {
+	std::ofstream file(fileName);
+	if(!file) {
+		throw esl::system::Stacktrace::add(std::runtime_error("Cannot create file \"" + fileName + "\" for boot timeline"));
+	}
+
+	std::vector<Record> allRecords = getRecords();
+	long pid = static_cast<long>(getpid());
+
+	file << "{\"traceEvents\":[";
+	for(std::size_t i = 0; i < allRecords.size(); ++i) {
+		const Record& record = allRecords[i];
+		file << (i == 0 ? "\n" : ",\n")
+			<< "{\"name\":\"" << escapeJSON(record.name) << "\""
+			<< ",\"cat\":\"jboot\",\"ph\":\"X\""
+			<< ",\"ts\":" << std::chrono::duration_cast<std::chrono::microseconds>(record.begin).count()
+			<< ",\"dur\":" << std::chrono::duration_cast<std::chrono::microseconds>(record.wall).count()
+			<< ",\"pid\":" << pid
+			<< ",\"tid\":" << (record.threadId % 1000000)
+			<< ",\"args\":{\"detail\":\"" << escapeJSON(record.detail) << "\""
+			<< ",\"cpu_us\":" << std::chrono::duration_cast<std::chrono::microseconds>(record.cpu).count()
+			<< ",\"rss_delta_kib\":" << (record.rssDelta / 1024)
+			<< "}}";
+	}
+	file << "\n]}\n";
+}
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
@@ -0,0 +1,70 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_BOOT_CONTEXT_TIMELINE_H_
+#define JBOOT_BOOT_CONTEXT_TIMELINE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace jboot {
+namespace boot {
+namespace context {
+
+/* Records the steps of booting: parsing configuration files, loading libraries, creating and
+ * initializing objects. Recording is off until a boot context enables it, then every step
+ * stores wall time, CPU time of its thread and the growth of the resident set size. */
+class Timeline final {
+public:
+	class Step {
+	public:
+		Step(const char* name, const std::string& detail = "");
+		~Step();
+
+		Step(const Step&) = delete;
+		Step& operator=(const Step&) = delete;
+
+	private:
+		const bool enabled;
+		const char* name;
+		std::string detail;
+		unsigned int depth = 0;
+		std::chrono::steady_clock::time_point wallBegin;
+		std::chrono::nanoseconds cpuBegin { 0 };
+		std::int64_t rssBegin = 0;
+	};
+
+	Timeline() = delete;
+
+	static void enable();
+	static bool isEnabled() noexcept;
+
+	/* writes all steps recorded so far as indented list */
+	static void report(std::ostream& oStream);
+
+	/* writes all steps recorded so far in Chrome trace event format (chrome://tracing, Perfetto) */
+	static void writeChromeTrace(const std::string& fileName);
+};
+
+} /* namespace context */
+} /* namespace boot */
+} /* namespace jboot */
+
+#endif /* JBOOT_BOOT_CONTEXT_TIMELINE_H_ */
@@ -71,11 +71,27 @@ BasicClient::BasicClient(const std::string& fileName, const tinyxml2::XMLElement
 				throw XMLException(*this, "Attribute 'ref-id' is not allowed together with attribute 'implementation'.");
 			}
 		}
+		else if(attributeName == "lazy") {
+			if(hasLazy) {
+				throw XMLException(*this, "Multiple definition of attribute 'lazy'");
+			}
+			hasLazy = true;
+			if(!stringToBool(lazy, attribute->Value())) {
+				throw XMLException(*this, "Invalid value \"" + std::string(attribute->Value()) + "\" for attribute 'lazy'");
+			}
+		}
 		else {
 			throw XMLException(*this, "Unknown attribute '" + attributeName + "'");
 		}
 	}
 
+	if(lazy && id.empty()) {
+		throw XMLException(*this, "Attribute 'lazy' requires attribute 'id'.");
+	}
+	if(lazy && !refId.empty()) {
+		throw XMLException(*this, "Attribute 'lazy' is not allowed together with attribute 'ref-id'.");
+	}
+
 	if(id.empty()) {
 		throw XMLException(*this, "Missing attribute 'id'");
 	}
@@ -115,6 +131,10 @@ void BasicClient::save(std::ostream& oStream, std::size_t spaces) const {
 		oStream << " ref-id=\"" << refId << "\"";
 	}
 
+	if(hasLazy) {
+		oStream << " lazy=\"" << (lazy ? "true" : "false") << "\"";
+	}
+
 	if(settings.empty()) {
 		oStream << "/>\n";
 	}
@@ -132,7 +152,15 @@ void BasicClient::save(std::ostream& oStream, std::size_t spaces) const {
 
 void BasicClient::install(boot::context::Context& context) const {
 	if(refId.empty()) {
-		context.addObject(id, create());
+		if(!id.empty() && (hasLazy ? lazy : context.getLazyObjects())) {
+			/* copy, because the configuration is gone when the object gets created */
+			context.addLazyObject(id, [config = *this]() {
+				return config.create();
+			});
+		}
+		else {
+			context.addObject(id, create());
+		}
 	}
 	else {
 		context.addReference(id, refId);
@@ -146,7 +174,22 @@ void BasicClient::install(boot::context::Context& context) const {
 			}
 		}
 	}
-	context.addObject(id, create());
+}
+
+std::unique_ptr<esl::object::Object> BasicClient::preCreate(const boot::context::Context& context) const {
+	if(!refId.empty() || (!id.empty() && (hasLazy ? lazy : context.getLazyObjects()))) {
+		return nullptr;
+	}
+	return create();
+}
+
+void BasicClient::install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const {
+	if(object) {
+		context.addObject(id, std::move(object));
+	}
+	else {
+		install(context);
+	}
 }
 
 std::unique_ptr<esl::object::Object> BasicClient::create() const {
@@ -146,7 +146,22 @@ void BasicServer::install(boot::context::Context& context) const {
 			}
 		}
 	}
-	context.addObject(id, create());
+}
+
+std::unique_ptr<esl::object::Object> BasicServer::preCreate(const boot::context::Context&) const {
+	if(!refId.empty()) {
+		return nullptr;
+	}
+	return create();
+}
+
+void BasicServer::install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const {
+	if(object) {
+		context.addObject(id, std::move(object));
+	}
+	else {
+		install(context);
+	}
 }
 
 std::unique_ptr<esl::object::Object> BasicServer::create() const {
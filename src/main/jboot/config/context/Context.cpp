@@ -21,10 +21,14 @@
 #include <jboot/Logger.h>
 
 #include <jboot/config/context/EntryImpl.h>
+#include <jboot/boot/context/Timeline.h>
+#include <jboot/processing/task/ForkJoin.h>
+#include <jboot/processing/task/TaskFactory.h>
 
 #include <esl/plugin/Registry.h>
 #include <esl/logging/Logger.h>
 
+#include <exception>
 #include <iostream>
 #include <stdexcept>
 
@@ -194,9 +198,7 @@ void Context::install(boot::context::Context& context) {
 			eslLogger.install();
 		}
 
-		for(const auto& entry : entries) {
-			entry->install(context);
-		}
+		installEntries(context);
 	}
 	else {
 		if(refId.empty()) {
@@ -208,6 +210,44 @@ void Context::install(boot::context::Context& context) {
 	}
 }
 
+void Context::installEntries(boot::context::Context& context) {
+	if(context.getInstallThreads() > 1 && entries.size() > 1) {
+		installParallel(context);
+	}
+	else for(const auto& entry : entries) {
+		entry->install(context);
+	}
+}
+
+void Context::installParallel(boot::context::Context& context) {
+	std::vector<std::unique_ptr<esl::object::Object>> objects(entries.size());
+	std::vector<std::exception_ptr> exceptions(entries.size());
+
+	/* Objects are created by their plugins independent from the context, so they can be created in any order.
+	 * References are installed afterwards in declaration order, when the referenced objects exist. */
+	{
+		unsigned int helpers = context.getInstallThreads() - 1;
+		processing::task::TaskFactory taskFactory(std::vector<std::pair<std::string, std::string>>{{ "max-threads", std::to_string(helpers) }});
+
+		processing::task::ForkJoin::run(taskFactory, entries.size(), [this, &context, &objects, &exceptions](std::size_t index) {
+			try {
+				objects[index] = entries[index]->preCreate(context);
+			}
+			catch(...) {
+				exceptions[index] = std::current_exception();
+			}
+		}, helpers);
+	}
+
+	/* same result as sequential install: everything before the first failing entry is installed */
+	for(std::size_t index = 0; index < entries.size(); ++index) {
+		if(exceptions[index]) {
+			std::rethrow_exception(exceptions[index]);
+		}
+		entries[index]->install(context, std::move(objects[index]));
+	}
+}
+
 void Context::loadLibraries() {
 	/* ************************
 	 * load and add libraries *
@@ -218,8 +258,14 @@ void Context::loadLibraries() {
 			throw esl::addStacktrace(std::runtime_error(std::string("Library \"") + library.first + "\" loaded already."));
 		}
 		*/
-		library.second = &esl::plugin::Library::load(library.first);
-		library.second->install(esl::plugin::Registry::get());
+		{
+			boot::context::Timeline::Step step("load-library", library.first);
+			library.second = &esl::plugin::Library::load(library.first);
+		}
+		{
+			boot::context::Timeline::Step step("install-library", library.first);
+			library.second->install(esl::plugin::Registry::get());
+		}
 	}
 }
 
@@ -329,6 +375,7 @@ void Context::parseInclude(const tinyxml2::XMLElement& element) {
 	}
 
 	if(filesLoaded.count(fileName) == 0) {
+		boot::context::Timeline::Step step("include", fileName);
 		auto oldXmlFile = setXMLFile(fileName, -1);
 		filesLoaded.insert(fileName);
 
@@ -52,6 +52,8 @@ public:
 
 	void save(std::ostream& oStream, std::size_t spaces = 0) const;
 	void install(boot::context::Context& context);
+	/* installs the entries without the loggers, used by reload */
+	void installEntries(boot::context::Context& context);
 	void loadLibraries();
 
 private:
@@ -71,6 +73,7 @@ private:
 	std::vector<logging::Logger> eslLoggers;
 
 	std::unique_ptr<esl::object::Object> create() const;
+	void installParallel(boot::context::Context& context);
 	void parseInnerElement(const tinyxml2::XMLElement& element);
 
 	void loadXML(const tinyxml2::XMLElement& element);
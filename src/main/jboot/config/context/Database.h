@@ -43,10 +43,17 @@ public:
 	void save(std::ostream& oStream, std::size_t spaces) const;
 	void install(boot::context::Context& context) const;
 
+	/* Creates the object without adding it to the context, so objects can be created in parallel.
+	 * Returns nullptr if the entry has to be installed by install(context). */
+	std::unique_ptr<esl::object::Object> preCreate(const boot::context::Context& context) const;
+	void install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const;
+
 private:
 	std::string id;
 	std::string implementation;
 	std::string refId;
+	bool hasLazy = false;
+	bool lazy = false;
 	std::vector<Setting> settings;
 
 	std::unique_ptr<esl::object::Object> create() const;
@@ -22,6 +22,9 @@
 #include <jboot/config/Config.h>
 #include <jboot/boot/context/Context.h>
 
+#include <esl/object/Object.h>
+
+#include <memory>
 #include <string>
 #include <ostream>
 
@@ -35,6 +38,12 @@ public:
 
 	virtual void save(std::ostream& oStream, std::size_t spaces) const = 0;
 	virtual void install(boot::context::Context& context) const = 0;
+
+	/* Creates the object of the entry without adding it to the context. Returns nullptr if the
+	 * entry cannot be created in advance, e.g. a reference. preCreate() is called concurrently
+	 * for different entries, install(context, object) in declaration order. */
+	virtual std::unique_ptr<esl::object::Object> preCreate(const boot::context::Context& context) const = 0;
+	virtual void install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const = 0;
 };
 
 } /* namespace context */
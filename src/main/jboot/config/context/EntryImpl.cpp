@@ -19,6 +19,9 @@
 #include <jboot/config/context/EntryImpl.h>
 #include <jboot/config/XMLException.h>
 #include <jboot/boot/context/Context.h>
+#include <jboot/boot/context/Timeline.h>
+
+#include <sstream>
 
 namespace jboot {
 namespace config {
@@ -84,6 +87,13 @@ void EntryImpl::save(std::ostream& oStream, std::size_t spaces) const {
 }
 
 void EntryImpl::install(boot::context::Context& context) const {
+	boot::context::Context::Install install(context, getSignature());
+	if(install.isReused()) {
+		return;
+	}
+
+	boot::context::Timeline::Step step("create", getFileName() + ":" + std::to_string(getLineNo()));
+
 	if(basicClient) {
 		basicClient->install(context);
 	}
@@ -107,6 +117,73 @@ void EntryImpl::install(boot::context::Context& context) const {
 	}
 }
 
+std::unique_ptr<esl::object::Object> EntryImpl::preCreate(const boot::context::Context& context) const {
+	if(context.isReused(getSignature())) {
+		return nullptr;
+	}
+
+	boot::context::Timeline::Step step("create", getFileName() + ":" + std::to_string(getLineNo()));
+
+	if(basicClient) {
+		return basicClient->preCreate(context);
+	}
+	if(basicServer) {
+		return basicServer->preCreate(context);
+	}
+	if(database) {
+		return database->preCreate(context);
+	}
+	if(httpClient) {
+		return httpClient->preCreate(context);
+	}
+	if(httpServer) {
+		return httpServer->preCreate(context);
+	}
+	if(object) {
+		return object->preCreate(context);
+	}
+	if(procedure) {
+		return procedure->preCreate(context);
+	}
+	return nullptr;
+}
+
+void EntryImpl::install(boot::context::Context& context, std::unique_ptr<esl::object::Object> aObject) const {
+	boot::context::Context::Install install(context, getSignature());
+	if(install.isReused()) {
+		return;
+	}
+
+	if(basicClient) {
+		basicClient->install(context, std::move(aObject));
+	}
+	if(basicServer) {
+		basicServer->install(context, std::move(aObject));
+	}
+	if(database) {
+		database->install(context, std::move(aObject));
+	}
+	if(httpClient) {
+		httpClient->install(context, std::move(aObject));
+	}
+	if(httpServer) {
+		httpServer->install(context, std::move(aObject));
+	}
+	if(object) {
+		object->install(context, std::move(aObject));
+	}
+	if(procedure) {
+		procedure->install(context, std::move(aObject));
+	}
+}
+
+std::string EntryImpl::getSignature() const {
+	/* id, implementation, ref-id and all parameters, but neither file name nor line number */
+	std::ostringstream signature;
+	save(signature, 0);
+	return signature.str();
+}
+
 } /* namespace context */
 } /* namespace config */
 } /* namespace jboot */
@@ -32,6 +32,7 @@
 
 #include <memory>
 #include <ostream>
+#include <string>
 
 #include <tinyxml2/tinyxml2.h>
 
@@ -45,6 +46,8 @@ public:
 
 	void save(std::ostream& oStream, std::size_t spaces) const override;
 	void install(boot::context::Context& context) const override;
+	std::unique_ptr<esl::object::Object> preCreate(const boot::context::Context& context) const override;
+	void install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const override;
 
 private:
 	std::unique_ptr<Object> object;
@@ -57,6 +60,9 @@ private:
 
 	std::unique_ptr<HttpClient> httpClient;
 	std::unique_ptr<HttpServer> httpServer;
+
+	/* identifies the configuration of the entry for reload */
+	std::string getSignature() const;
 };
 
 } /* namespace context */
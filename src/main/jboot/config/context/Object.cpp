@@ -70,11 +70,27 @@ Object::Object(const std::string& fileName, const tinyxml2::XMLElement& element)
 				throw XMLException(*this, "Attribute 'ref-id' is not allowed together with attribute 'implementation'.");
 			}
 		}
+		else if(attributeName == "lazy") {
+			if(hasLazy) {
+				throw XMLException(*this, "Multiple definition of attribute 'lazy'");
+			}
+			hasLazy = true;
+			if(!stringToBool(lazy, attribute->Value())) {
+				throw XMLException(*this, "Invalid value \"" + std::string(attribute->Value()) + "\" for attribute 'lazy'");
+			}
+		}
 		else {
 			throw XMLException(*this, "Unknown attribute '" + attributeName + "'");
 		}
 	}
 
+	if(lazy && id.empty()) {
+		throw XMLException(*this, "Attribute 'lazy' requires attribute 'id'.");
+	}
+	if(lazy && !refId.empty()) {
+		throw XMLException(*this, "Attribute 'lazy' is not allowed together with attribute 'ref-id'.");
+	}
+
 	if(refId.empty() && implementation.empty()) {
 		throw XMLException(*this, "Attribute 'implementation' is missing.");
 	}
@@ -111,6 +127,10 @@ void Object::save(std::ostream& oStream, std::size_t spaces) const {
 		oStream << " ref-id=\"" << refId << "\"";
 	}
 
+	if(hasLazy) {
+		oStream << " lazy=\"" << (lazy ? "true" : "false") << "\"";
+	}
+
 	if(settings.empty()) {
 		oStream << "/>\n";
 	}
@@ -127,13 +147,37 @@ void Object::save(std::ostream& oStream, std::size_t spaces) const {
 
 void Object::install(boot::context::Context& context) const {
 	if(refId.empty()) {
-		context.addObject(id, create());
+		if(!id.empty() && (hasLazy ? lazy : context.getLazyObjects())) {
+			/* copy, because the configuration is gone when the object gets created */
+			context.addLazyObject(id, [config = *this]() {
+				return config.create();
+			});
+		}
+		else {
+			context.addObject(id, create());
+		}
 	}
 	else {
 		context.addReference(id, refId);
 	}
 }
 
+std::unique_ptr<esl::object::Object> Object::preCreate(const boot::context::Context& context) const {
+	if(!refId.empty() || (!id.empty() && (hasLazy ? lazy : context.getLazyObjects()))) {
+		return nullptr;
+	}
+	return create();
+}
+
+void Object::install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const {
+	if(object) {
+		context.addObject(id, std::move(object));
+	}
+	else {
+		install(context);
+	}
+}
+
 std::unique_ptr<esl::object::Object> Object::create() const {
 	std::vector<std::pair<std::string, std::string>> eslSettings;
 	for(const auto& setting : settings) {
@@ -18,6 +18,7 @@
 
 #include <jboot/config/context/Procedure.h>
 #include <jboot/config/XMLException.h>
+#include <jboot/processing/procedure/InstancePool.h>
 
 #include <esl/processing/Procedure.h>
 #include <esl/plugin/Registry.h>
@@ -69,11 +70,53 @@ Procedure::Procedure(const std::string& fileName, const tinyxml2::XMLElement& el
 				throw XMLException(*this, "Attribute 'ref-id' is not allowed together with attribute 'implementation'.");
 			}
 		}
+		else if(attributeName == "lazy") {
+			if(hasLazy) {
+				throw XMLException(*this, "Multiple definition of attribute 'lazy'");
+			}
+			hasLazy = true;
+			if(!stringToBool(lazy, attribute->Value())) {
+				throw XMLException(*this, "Invalid value \"" + std::string(attribute->Value()) + "\" for attribute 'lazy'");
+			}
+		}
+		else if(attributeName == "instances") {
+			if(!instances.empty()) {
+				throw XMLException(*this, "Multiple definition of attribute 'instances'");
+			}
+			instances = attribute->Value();
+			if(instances == "pool" || instances.compare(0, 5, "pool:") == 0) {
+				try {
+					std::size_t pos;
+					long size = std::stol(instances.substr(5), &pos);
+					if(size <= 0 || pos != instances.size() - 5) {
+						throw std::runtime_error("");
+					}
+					poolSize = static_cast<std::size_t>(size);
+				}
+				catch(...) {
+					throw XMLException(*this, "Invalid value \"" + instances + "\" for attribute 'instances'. Pool size must be > 0, e.g. \"pool:4\"");
+				}
+			}
+			else if(instances != "shared" && instances != "per-thread") {
+				throw XMLException(*this, "Invalid value \"" + instances + "\" for attribute 'instances'");
+			}
+		}
 		else {
 			throw XMLException(*this, "Unknown attribute '" + attributeName + "'");
 		}
 	}
 
+	if(lazy && id.empty()) {
+		throw XMLException(*this, "Attribute 'lazy' requires attribute 'id'.");
+	}
+	if(lazy && !refId.empty()) {
+		throw XMLException(*this, "Attribute 'lazy' is not allowed together with attribute 'ref-id'.");
+	}
+
+	if(!instances.empty() && !refId.empty()) {
+		throw XMLException(*this, "Attribute 'instances' is not allowed together with attribute 'ref-id'.");
+	}
+
 	if(refId.empty() && implementation.empty()) {
 		throw XMLException(*this, "Attribute 'implementation' is missing.");
 	}
@@ -110,6 +153,14 @@ void Procedure::save(std::ostream& oStream, std::size_t spaces) const {
 		oStream << " ref-id=\"" << refId << "\"";
 	}
 
+	if(hasLazy) {
+		oStream << " lazy=\"" << (lazy ? "true" : "false") << "\"";
+	}
+
+	if(!instances.empty()) {
+		oStream << " instances=\"" << instances << "\"";
+	}
+
 	if(settings.empty()) {
 		oStream << "/>\n";
 	}
@@ -126,7 +177,15 @@ void Procedure::save(std::ostream& oStream, std::size_t spaces) const {
 
 void Procedure::install(boot::context::Context& context) const {
 	if(refId.empty()) {
-		context.addObject(id, create());
+		if(!id.empty() && (hasLazy ? lazy : context.getLazyObjects())) {
+			/* copy, because the configuration is gone when the object gets created */
+			context.addLazyObject(id, [config = *this]() {
+				return config.create();
+			});
+		}
+		else {
+			context.addObject(id, create());
+		}
 	}
 	else {
 		context.addReference(id, refId);
@@ -142,7 +201,39 @@ void Procedure::install(boot::context::Context& context) const {
 	}
 }
 
+std::unique_ptr<esl::object::Object> Procedure::preCreate(const boot::context::Context& context) const {
+	if(!refId.empty() || (!id.empty() && (hasLazy ? lazy : context.getLazyObjects()))) {
+		return nullptr;
+	}
+	return create();
+}
+
+void Procedure::install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const {
+	if(object) {
+		context.addObject(id, std::move(object));
+	}
+	else {
+		install(context);
+	}
+}
+
 std::unique_ptr<esl::object::Object> Procedure::create() const {
+	/* copy, because instances are created after the configuration is gone */
+	if(instances == "per-thread") {
+		return std::unique_ptr<esl::object::Object>(new processing::procedure::InstancePool([config = *this]() {
+			return config.createProcedure();
+		}, processing::procedure::InstancePool::perThread));
+	}
+	if(poolSize > 0) {
+		return std::unique_ptr<esl::object::Object>(new processing::procedure::InstancePool([config = *this]() {
+			return config.createProcedure();
+		}, processing::procedure::InstancePool::pool, poolSize));
+	}
+
+	return std::unique_ptr<esl::object::Object>(createProcedure().release());
+}
+
+std::unique_ptr<esl::processing::Procedure> Procedure::createProcedure() const {
 	std::vector<std::pair<std::string, std::string>> eslSettings;
 	for(const auto& setting : settings) {
 		eslSettings.push_back(std::make_pair(setting.key, evaluate(setting.value, setting.language)));
@@ -163,7 +254,7 @@ std::unique_ptr<esl::object::Object> Procedure::create() const {
 		throw XMLException(*this, "Could not create procedure with id '" + id + "' for implementation '" + implementation + "' because interface method createProcedure() returns nullptr.");
 	}
 
-	return std::unique_ptr<esl::object::Object>(procedure.release());
+	return procedure;
 }
 
 void Procedure::parseInnerElement(const tinyxml2::XMLElement& element) {
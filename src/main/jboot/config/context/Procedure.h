@@ -24,6 +24,7 @@
 #include <jboot/boot/context/Context.h>
 
 #include <esl/object/Object.h>
+#include <esl/processing/Procedure.h>
 
 #include <tinyxml2/tinyxml2.h>
 
@@ -43,13 +44,26 @@ public:
 	void save(std::ostream& oStream, std::size_t spaces) const;
 	void install(boot::context::Context& context) const;
 
+	/* Creates the object without adding it to the context, so objects can be created in parallel.
+	 * Returns nullptr if the entry has to be installed by install(context). */
+	std::unique_ptr<esl::object::Object> preCreate(const boot::context::Context& context) const;
+	void install(boot::context::Context& context, std::unique_ptr<esl::object::Object> object) const;
+
 protected:
 	std::unique_ptr<esl::object::Object> create() const;
+	std::unique_ptr<esl::processing::Procedure> createProcedure() const;
 
 private:
 	std::string id;
 	std::string implementation;
 	std::string refId;
+	bool hasLazy = false;
+	bool lazy = false;
+
+	/* "shared" (default), "per-thread" or "pool:<size>" */
+	std::string instances;
+	std::size_t poolSize = 0;
+
 	std::vector<Setting> settings;
 
 	void parseInnerElement(const tinyxml2::XMLElement& element);
@@ -0,0 +1,44 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_OBJECT_AFTERINITIALIZE_H_
+#define JBOOT_OBJECT_AFTERINITIALIZE_H_
+
+#include <functional>
+
+namespace jboot {
+namespace object {
+
+/* Implemented by an esl::object::Context that can defer work of its objects until the initialization
+ * of the top level context has finished and no initialization lock is held by the calling thread,
+ * e.g. to fork processes or to run procedures that look up lazy objects. */
+class AfterInitialize {
+public:
+	virtual ~AfterInitialize() = default;
+
+	/* 'function' runs immediately if the calling thread is not initializing a context */
+	virtual void runAfterInitialize(const void* owner, std::function<void()> function) = 0;
+
+	/* drops the functions of the owner that have not run yet */
+	virtual void cancelAfterInitialize(const void* owner) noexcept = 0;
+};
+
+} /* namespace object */
+} /* namespace jboot */
+
+#endif /* JBOOT_OBJECT_AFTERINITIALIZE_H_ */
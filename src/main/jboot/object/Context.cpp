@@ -35,7 +35,7 @@ std::set<std::string> Context::getObjectIds() const {
 }
 
 void Context::addRawObject(const std::string& id, std::unique_ptr<esl::object::Object> object) {
-	if(objects.insert(std::make_pair(id, std::move(object))).second == false) {
+	if(objects.emplace(id, std::move(object)).second == false) {
 		throw esl::system::Stacktrace::add(std::runtime_error("Cannot add element \"" + id + "\" to context because there exists already an object with same id"));
 	}
 }
@@ -19,10 +19,10 @@
 #include <esl/object/Context.h>
 #include <esl/object/Object.h>
 
-#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 #ifndef JBOOT_OBJECT_CONTEXT_H_
 #define JBOOT_OBJECT_CONTEXT_H_
@@ -40,7 +40,8 @@ protected:
 	const esl::object::Object* findRawObject(const std::string& id) const override;
 
 private:
-	std::map<std::string, std::unique_ptr<esl::object::Object>> objects;
+	/* Ids of request contexts are arbitrary, so they are not interned like the ids of boot contexts */
+	std::unordered_map<std::string, std::unique_ptr<esl::object::Object>> objects;
 };
 
 } /* namespace object */
@@ -0,0 +1,177 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/object/Epoch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace object {
+
+/* One slot per thread. Slots are never deleted, but reused by new threads. */
+struct Slot {
+	std::atomic<std::uint64_t> epoch { std::numeric_limits<std::uint64_t>::max() };
+	std::atomic<bool> used { true };
+	unsigned int nesting = 0;
+	Slot* next = nullptr;
+};
+
+namespace {
+constexpr std::uint64_t inactive = std::numeric_limits<std::uint64_t>::max();
+
+std::atomic<std::uint64_t> globalEpoch { 1 };
+std::atomic<Slot*> slots { nullptr };
+std::atomic<std::size_t> retiredCount { 0 };
+
+struct Retired {
+	std::uint64_t epoch;
+	const void* owner;
+	std::function<void()> release;
+};
+
+std::mutex& getRetiredMutex() {
+	static std::mutex retiredMutex;
+	return retiredMutex;
+}
+
+std::vector<Retired>& getRetired() {
+	static std::vector<Retired> retired;
+	return retired;
+}
+
+Slot* acquireSlot() {
+	for(Slot* slot = slots.load(); slot; slot = slot->next) {
+		bool expected = false;
+		if(!slot->used.load(std::memory_order_relaxed) && slot->used.compare_exchange_strong(expected, true)) {
+			return slot;
+		}
+	}
+
+	Slot* slot = new Slot;
+	slot->next = slots.load();
+	while(!slots.compare_exchange_weak(slot->next, slot)) {
+	}
+	return slot;
+}
+
+struct ThreadSlot {
+	Slot* slot = acquireSlot();
+
+	~ThreadSlot() {
+		slot->used.store(false, std::memory_order_release);
+	}
+};
+thread_local ThreadSlot threadSlot;
+
+void reclaim(bool wait) {
+	std::vector<std::function<void()>> releases;
+	{
+		std::unique_lock<std::mutex> lock(getRetiredMutex(), std::defer_lock);
+		if(wait) {
+			lock.lock();
+		}
+		else if(!lock.try_lock()) {
+			return;
+		}
+
+		std::uint64_t minEpoch = inactive;
+		for(Slot* slot = slots.load(); slot; slot = slot->next) {
+			minEpoch = std::min(minEpoch, slot->epoch.load());
+		}
+
+		/* A reader with epoch e might have seen data retired at epoch e or later */
+		std::vector<Retired>& retired = getRetired();
+		auto iter = std::stable_partition(retired.begin(), retired.end(), [minEpoch](const Retired& item) {
+			return item.epoch >= minEpoch;
+		});
+		for(auto releaseIter = iter; releaseIter != retired.end(); ++releaseIter) {
+			releases.push_back(std::move(releaseIter->release));
+		}
+		retired.erase(iter, retired.end());
+		retiredCount.store(retired.size(), std::memory_order_relaxed);
+	}
+
+	/* called without lock, because releasing might retire something again */
+	for(auto& release : releases) {
+		release();
+	}
+}
+} /* anonymous namespace */
+
+Epoch::Guard::Guard()
+: slot(threadSlot.slot)
+{
+	if(slot->nesting++ == 0) {
+		/* sequentially consistent, so the writer either sees this epoch or the reader sees the new version */
+		slot->epoch.store(globalEpoch.load());
+	}
+}
+
+Epoch::Guard::~Guard() {
+	if(--slot->nesting == 0) {
+		slot->epoch.store(inactive, std::memory_order_release);
+
+		if(retiredCount.load(std::memory_order_relaxed) > 0) {
+			jboot::object::reclaim(false);
+		}
+	}
+}
+
+void Epoch::retire(const void* owner, std::function<void()> release) {
+	{
+		std::lock_guard<std::mutex> lock(getRetiredMutex());
+		getRetired().push_back(Retired{globalEpoch.fetch_add(1), owner, std::move(release)});
+		retiredCount.store(getRetired().size(), std::memory_order_relaxed);
+	}
+
+	jboot::object::reclaim(true);
+}
+
+void Epoch::releaseAll(const void* owner) {
+	std::vector<std::function<void()>> releases;
+	{
+		std::lock_guard<std::mutex> lock(getRetiredMutex());
+
+		std::vector<Retired>& retired = getRetired();
+		auto iter = std::stable_partition(retired.begin(), retired.end(), [owner](const Retired& item) {
+			return item.owner != owner;
+		});
+		for(auto releaseIter = iter; releaseIter != retired.end(); ++releaseIter) {
+			releases.push_back(std::move(releaseIter->release));
+		}
+		retired.erase(iter, retired.end());
+		retiredCount.store(retired.size(), std::memory_order_relaxed);
+	}
+
+	for(auto& release : releases) {
+		release();
+	}
+}
+
+void Epoch::reclaim() {
+	jboot::object::reclaim(true);
+}
+
+} /* namespace object */
+} /* namespace jboot */
@@ -0,0 +1,61 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_OBJECT_EPOCH_H_
+#define JBOOT_OBJECT_EPOCH_H_
+
+#include <functional>
+
+namespace jboot {
+namespace object {
+
+/* Epoch based reclamation for data that is read without locks.
+ * A writer publishes a new version through an atomic pointer and retires the old version.
+ * The old version is released when every reader that might have seen it has left its Guard. */
+class Epoch final {
+public:
+	/* Readers access published data inside a Guard only. Guards can be nested. Nothing retired
+	 * while a Guard is alive gets released before it ends, so a Guard must not be held for long. */
+	class Guard {
+	public:
+		Guard();
+		~Guard();
+
+		Guard(const Guard&) = delete;
+		Guard& operator=(const Guard&) = delete;
+
+	private:
+		struct Slot* slot;
+	};
+
+	Epoch() = delete;
+
+	static void retire(const void* owner, std::function<void()> release);
+
+	/* Releases everything retired by 'owner' without waiting for readers.
+	 * Only allowed if no reader of the data of 'owner' exists anymore, e.g. in its destructor. */
+	static void releaseAll(const void* owner);
+
+	/* Releases retired data that has no readers anymore */
+	static void reclaim();
+};
+
+} /* namespace object */
+} /* namespace jboot */
+
+#endif /* JBOOT_OBJECT_EPOCH_H_ */
@@ -0,0 +1,42 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_OBJECT_EVENTBATCH_H_
+#define JBOOT_OBJECT_EVENTBATCH_H_
+
+#include <esl/object/Object.h>
+
+#include <cstddef>
+
+namespace jboot {
+namespace object {
+
+/* Implemented by an esl::object::Event that can handle several events with one call.
+ * A boot context passes a batch to entries implementing this interface and calls
+ * onEvent for each object of the batch on all other entries. */
+class EventBatch {
+public:
+	virtual ~EventBatch() = default;
+
+	virtual void onEvents(const esl::object::Object* const* objects, std::size_t count) = 0;
+};
+
+} /* namespace object */
+} /* namespace jboot */
+
+#endif /* JBOOT_OBJECT_EVENTBATCH_H_ */
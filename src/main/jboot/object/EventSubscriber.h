@@ -0,0 +1,42 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_OBJECT_EVENTSUBSCRIBER_H_
+#define JBOOT_OBJECT_EVENTSUBSCRIBER_H_
+
+#include <typeinfo>
+
+namespace jboot {
+namespace object {
+
+/* Implemented by an esl::object::Event that handles some event types only.
+ * A boot context asks once per event type and then sends events of this type
+ * only to the entries that are subscribed. Entries that are an esl::object::Event
+ * without implementing this interface receive all events. */
+class EventSubscriber {
+public:
+	virtual ~EventSubscriber() = default;
+
+	/* 'type' is the dynamic type of the event object */
+	virtual bool isSubscribed(const std::type_info& type) const = 0;
+};
+
+} /* namespace object */
+} /* namespace jboot */
+
+#endif /* JBOOT_OBJECT_EVENTSUBSCRIBER_H_ */
@@ -0,0 +1,36 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_OBJECT_REUSABLE_H_
+#define JBOOT_OBJECT_REUSABLE_H_
+
+namespace jboot {
+namespace object {
+
+/* Implemented by objects that implement esl::object::InitializeContext but keep no objects of the
+ * configuration they have been initialized with. The boot context takes them over on reload like
+ * other objects, if their configuration entry has not been changed. */
+class Reusable {
+public:
+	virtual ~Reusable() = default;
+};
+
+} /* namespace object */
+} /* namespace jboot */
+
+#endif /* JBOOT_OBJECT_REUSABLE_H_ */
@@ -0,0 +1,73 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/object/Symbol.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace jboot {
+namespace object {
+
+namespace {
+const std::string emptyName;
+} /* anonymous namespace */
+
+Symbol Symbol::intern(std::string_view name) {
+	/* function local statics, because symbols might be interned during static initialization */
+	static std::shared_mutex mutex;
+	static std::unordered_map<std::string_view, std::unique_ptr<Entry>> entries;
+
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		auto iter = entries.find(name);
+		if(iter != entries.end()) {
+			return Symbol(*iter->second);
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	auto iter = entries.find(name);
+	if(iter != entries.end()) {
+		return Symbol(*iter->second);
+	}
+
+	std::unique_ptr<Entry> entry(new Entry{std::string(name), hash(name)});
+	const Entry& entryRef = *entry;
+	/* key refers to the name stored in the entry */
+	entries.emplace(std::string_view(entryRef.name), std::move(entry));
+	return Symbol(entryRef);
+}
+
+std::size_t Symbol::hash(std::string_view name) noexcept {
+	return std::hash<std::string_view>()(name);
+}
+
+const std::string& Symbol::getName() const noexcept {
+	return entry ? entry->name : emptyName;
+}
+
+std::size_t Symbol::getHash() const noexcept {
+	return entry ? entry->hash : hash(std::string_view());
+}
+
+} /* namespace object */
+} /* namespace jboot */
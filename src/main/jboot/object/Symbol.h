@@ -0,0 +1,73 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_OBJECT_SYMBOL_H_
+#define JBOOT_OBJECT_SYMBOL_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace jboot {
+namespace object {
+
+/* Interned object id. All symbols with the same name share one entry of a global table,
+ * so symbols are compared by pointer and the hash of the name is calculated once.
+ * Entries are never released, so only ids of boot contexts are interned, which come from the
+ * configuration. Ids of request contexts are arbitrary and must not be interned. */
+class Symbol {
+public:
+	Symbol() = default;
+
+	static Symbol intern(std::string_view name);
+	static std::size_t hash(std::string_view name) noexcept;
+
+	bool empty() const noexcept {
+		return entry == nullptr;
+	}
+
+	/* The returned reference is valid until the process ends */
+	const std::string& getName() const noexcept;
+
+	std::size_t getHash() const noexcept;
+
+	bool operator==(const Symbol& other) const noexcept {
+		return entry == other.entry;
+	}
+
+	bool operator!=(const Symbol& other) const noexcept {
+		return entry != other.entry;
+	}
+
+private:
+	struct Entry {
+		std::string name;
+		std::size_t hash;
+	};
+
+	Symbol(const Entry& aEntry)
+	: entry(&aEntry)
+	{ }
+
+	const Entry* entry = nullptr;
+};
+
+} /* namespace object */
+} /* namespace jboot */
+
+#endif /* JBOOT_OBJECT_SYMBOL_H_ */
@@ -0,0 +1,136 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_OBJECT_SYMBOLMAP_H_
+#define JBOOT_OBJECT_SYMBOLMAP_H_
+
+#include <jboot/object/Symbol.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace object {
+
+/* Open addressing hash map from Symbol to T with lookup by std::string_view.
+ * Values are stored in insertion order and never move, so pointers to values stay valid
+ * and iteration gives the order the values have been added.
+ * Not thread safe for concurrent insert and find. */
+template<typename T>
+class SymbolMap {
+public:
+	using value_type = std::pair<Symbol, T>;
+
+	typename std::deque<value_type>::iterator begin() {
+		return values.begin();
+	}
+
+	typename std::deque<value_type>::iterator end() {
+		return values.end();
+	}
+
+	typename std::deque<value_type>::const_iterator begin() const {
+		return values.begin();
+	}
+
+	typename std::deque<value_type>::const_iterator end() const {
+		return values.end();
+	}
+
+	std::size_t size() const noexcept {
+		return values.size();
+	}
+
+	/* returns nullptr if there is already a value with this symbol */
+	template<typename... Args>
+	T* emplace(Symbol symbol, Args&&... args) {
+		if(find(symbol.getName(), symbol.getHash())) {
+			return nullptr;
+		}
+
+		if((values.size() + 1) * 2 > slots.size()) {
+			rehash(slots.empty() ? 16 : slots.size() * 2);
+		}
+
+		values.emplace_back(std::piecewise_construct, std::forward_as_tuple(symbol), std::forward_as_tuple(std::forward<Args>(args)...));
+		insertSlot(symbol.getHash(), static_cast<std::uint32_t>(values.size()));
+
+		return &values.back().second;
+	}
+
+	T* find(std::string_view name) {
+		return find(name, Symbol::hash(name));
+	}
+
+	const T* find(std::string_view name) const {
+		return find(name, Symbol::hash(name));
+	}
+
+	/* hash has to be Symbol::hash(name) */
+	T* find(std::string_view name, std::size_t hash) {
+		return const_cast<T*>(static_cast<const SymbolMap&>(*this).find(name, hash));
+	}
+
+	const T* find(std::string_view name, std::size_t hash) const {
+		if(slots.empty()) {
+			return nullptr;
+		}
+
+		std::size_t mask = slots.size() - 1;
+		for(std::size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+			const value_type& value = values[slots[slot] - 1];
+			if(value.first.getHash() == hash && value.first.getName() == name) {
+				return &value.second;
+			}
+		}
+
+		return nullptr;
+	}
+
+private:
+	std::deque<value_type> values;
+
+	/* index + 1 of the value in 'values', 0 is an empty slot. Size is a power of 2. */
+	std::vector<std::uint32_t> slots;
+
+	void insertSlot(std::size_t hash, std::uint32_t index) {
+		std::size_t mask = slots.size() - 1;
+		std::size_t slot = hash & mask;
+		while(slots[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = index;
+	}
+
+	void rehash(std::size_t size) {
+		slots.assign(size, 0);
+		for(std::size_t i = 0; i < values.size(); ++i) {
+			insertSlot(values[i].first.getHash(), static_cast<std::uint32_t>(i + 1));
+		}
+	}
+};
+
+} /* namespace object */
+} /* namespace jboot */
+
+#endif /* JBOOT_OBJECT_SYMBOLMAP_H_ */
@@ -0,0 +1,421 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/procedure/FanOut.h>
+#include <jboot/Logger.h>
+
+#include <esl/processing/Status.h>
+#include <esl/processing/Task.h>
+#include <esl/processing/TaskDescriptor.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+namespace {
+Logger logger("jboot::processing::procedure::FanOut");
+} /* anonymous namespace */
+
+class FanOut::Overlay : public esl::object::Context {
+public:
+	Overlay(esl::object::Context& aParent)
+	: parent(&aParent)
+	{ }
+
+	std::set<std::string> getObjectIds() const override {
+		std::set<std::string> rv;
+		{
+			std::shared_lock<std::shared_mutex> lock(parentMutex);
+			if(parent) {
+				rv = static_cast<const esl::object::Context*>(parent)->getObjectIds();
+			}
+		}
+		for(const auto& object : objects) {
+			rv.insert(object.first);
+		}
+		return rv;
+	}
+
+	void mergeInto(esl::object::Context& context) {
+		for(auto& object : objects) {
+			if(context.findObject<esl::object::Object>(object.first)) {
+				logger.warn << "Dropping object \"" << object.first << "\" because there exists already an object with same id.\n";
+				continue;
+			}
+			context.addObject(object.first, std::move(object.second));
+		}
+	}
+
+	/* Called before the caller returns. A child that is still running finds no objects of the caller's context anymore. */
+	void detach() {
+		std::lock_guard<std::shared_mutex> lock(parentMutex);
+		parent = nullptr;
+	}
+
+protected:
+	void addRawObject(const std::string& id, std::unique_ptr<esl::object::Object> object) override {
+		if(objects.emplace(id, std::move(object)).second == false) {
+			throw std::runtime_error("Cannot add element \"" + id + "\" to context because there exists already an object with same id");
+		}
+	}
+
+	esl::object::Object* findRawObject(const std::string& id) override {
+		auto iter = objects.find(id);
+		if(iter != objects.end()) {
+			return iter->second.get();
+		}
+
+		std::shared_lock<std::shared_mutex> lock(parentMutex);
+		return parent ? parent->findObject<esl::object::Object>(id) : nullptr;
+	}
+
+	const esl::object::Object* findRawObject(const std::string& id) const override {
+		auto iter = objects.find(id);
+		if(iter != objects.end()) {
+			return iter->second.get();
+		}
+
+		std::shared_lock<std::shared_mutex> lock(parentMutex);
+		return parent ? static_cast<const esl::object::Context*>(parent)->findObject<esl::object::Object>(id) : nullptr;
+	}
+
+private:
+	mutable std::shared_mutex parentMutex;
+	esl::object::Context* parent;
+	std::unordered_map<std::string, std::unique_ptr<esl::object::Object>> objects;
+};
+
+/* Shared by the caller and the children, so a child that is still running when the caller returns
+ * keeps its overlay. Its result is discarded then. */
+struct FanOut::Run {
+	Run(esl::object::Context& context, std::size_t aSize)
+	: size(aSize),
+	  claimed(aSize),
+	  done(aSize, false),
+	  exceptions(aSize)
+	{
+		for(std::size_t i = 0; i < size; ++i) {
+			overlays.emplace_back(new Overlay(context));
+		}
+	}
+
+	const std::size_t size;
+	std::vector<std::shared_ptr<Overlay>> overlays;
+
+	/* a child is run by whoever claims it first: a worker of the task factory or the caller */
+	std::vector<std::atomic<bool>> claimed;
+
+	std::mutex mutex;
+	std::condition_variable endedCV;
+	std::size_t succeeded = 0;
+	std::size_t failed = 0;
+	bool canceled = false;
+	/* set when the caller has decided the result. Children ending afterwards are not counted. */
+	bool decided = false;
+	std::vector<bool> done;
+	std::vector<std::exception_ptr> exceptions;
+
+	bool claim(std::size_t index) {
+		bool expected = false;
+		return claimed[index].compare_exchange_strong(expected, true);
+	}
+
+	void runChild(std::size_t index, esl::processing::Procedure& procedure) {
+		std::exception_ptr exceptionPtr;
+
+		try {
+			procedure.procedureRun(*overlays[index]);
+		}
+		catch(...) {
+			exceptionPtr = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(decided) {
+			return;
+		}
+		if(exceptionPtr) {
+			exceptions[index] = exceptionPtr;
+			++failed;
+		}
+		else {
+			done[index] = true;
+			++succeeded;
+		}
+		endedCV.notify_all();
+	}
+
+	/* requires lock of mutex */
+	bool isSatisfied(std::size_t required) const {
+		return canceled || succeeded >= required || size - failed < required;
+	}
+};
+
+class FanOut::Child : public esl::processing::Procedure {
+public:
+	Child(std::shared_ptr<Run> aRun, std::size_t aIndex, esl::processing::Procedure& aProcedure)
+	: run(std::move(aRun)),
+	  index(aIndex),
+	  procedure(aProcedure)
+	{ }
+
+	void procedureRun(esl::object::Context&) override {
+		if(run->claim(index)) {
+			run->runChild(index, procedure);
+		}
+	}
+
+	/* The procedure is shared by all calls, so it is not canceled for this run only.
+	 * A canceled task that has not been started is skipped by the caller. */
+	void procedureCancel() override {
+	}
+
+private:
+	/* shared, because a worker might pick up the task or still run it after the caller has returned */
+	std::shared_ptr<Run> run;
+	std::size_t index;
+	esl::processing::Procedure& procedure;
+};
+
+std::unique_ptr<esl::processing::Procedure> FanOut::create(const std::vector<std::pair<std::string, std::string>>& settings) {
+	return std::unique_ptr<esl::processing::Procedure>(new FanOut(settings));
+}
+
+FanOut::FanOut(const std::vector<std::pair<std::string, std::string>>& settings) {
+	bool hasWaitFor = false;
+
+	for(const auto& setting : settings) {
+		if(setting.first == "procedure-id") {
+			if(setting.second.empty()) {
+				throw std::runtime_error("Invalid value \"\" for attribute 'procedure-id'.");
+			}
+			procedureIds.push_back(setting.second);
+		}
+		else if(setting.first == "task-factory-id") {
+			if(!taskFactoryId.empty()) {
+				throw std::runtime_error("multiple definition of attribute 'task-factory-id'.");
+			}
+			taskFactoryId = setting.second;
+			if(taskFactoryId.empty()) {
+				throw std::runtime_error("Invalid value \"\" for attribute 'task-factory-id'.");
+			}
+		}
+		else if(setting.first == "wait-for") {
+			if(hasWaitFor) {
+				throw std::runtime_error("multiple definition of attribute 'wait-for'.");
+			}
+			hasWaitFor = true;
+
+			if(setting.second != "all") {
+				long value;
+				try {
+					value = std::stol(setting.second);
+				}
+				catch(...) {
+					throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'wait-for'.");
+				}
+				if(value <= 0) {
+					throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'wait-for'. Value must be \"all\" or > 0");
+				}
+				waitFor = static_cast<std::size_t>(value);
+			}
+		}
+		else if(setting.first == "timeout-ms") {
+			if(hasTimeout) {
+				throw std::runtime_error("multiple definition of attribute 'timeout-ms'.");
+			}
+			hasTimeout = true;
+
+			long ms;
+			try {
+				ms = std::stol(setting.second);
+			}
+			catch(...) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'timeout-ms'.");
+			}
+			if(ms < 0) {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'timeout-ms'. Value must be >= 0");
+			}
+			timeout = std::chrono::milliseconds(ms);
+		}
+		else {
+			throw std::runtime_error("unknown attribute '\"" + setting.first + "\"'.");
+		}
+	}
+
+	if(procedureIds.empty()) {
+		throw std::runtime_error("Definition of 'procedure-id' is missing.");
+	}
+	if(taskFactoryId.empty()) {
+		throw std::runtime_error("Definition of 'task-factory-id' is missing.");
+	}
+	if(waitFor > procedureIds.size()) {
+		throw std::runtime_error("Invalid value \"" + std::to_string(waitFor) + "\" for attribute 'wait-for'. Value must not be greater than the number of procedures");
+	}
+}
+
+void FanOut::initializeContext(esl::object::Context& context) {
+	procedures.clear();
+	for(const auto& procedureId : procedureIds) {
+		esl::processing::Procedure* procedure = context.findObject<esl::processing::Procedure>(procedureId);
+		if(procedure == nullptr) {
+			throw std::runtime_error("Cannot find procedure with id '" + procedureId + "'.");
+		}
+		procedures.push_back(procedure);
+	}
+
+	taskFactory = context.findObject<esl::processing::TaskFactory>(taskFactoryId);
+	if(taskFactory == nullptr) {
+		throw std::runtime_error("Cannot find task factory with id '" + taskFactoryId + "'.");
+	}
+}
+
+void FanOut::procedureRun(esl::object::Context& context) {
+	if(taskFactory == nullptr) {
+		throw std::runtime_error("Fan out has not been initialized.");
+	}
+
+	const std::size_t size = procedures.size();
+	const std::size_t required = waitFor == 0 ? size : waitFor;
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+
+	std::shared_ptr<Run> run(new Run(context, size));
+	{
+		std::lock_guard<std::mutex> lock(runsMutex);
+		runs.insert(run.get());
+	}
+
+	std::vector<esl::processing::Task> tasks;
+	for(std::size_t i = 0; i < size; ++i) {
+		esl::processing::TaskDescriptor descriptor;
+		descriptor.procedure.reset(new Child(run, i, *procedures[i]));
+		try {
+			tasks.push_back(taskFactory->createTask(std::move(descriptor)));
+		}
+		catch(...) {
+			break;
+		}
+	}
+
+	/* If the task factory did not accept all children, the calling thread runs the remaining ones */
+	for(std::size_t i = tasks.size(); i < size; ++i) {
+		{
+			std::lock_guard<std::mutex> lock(run->mutex);
+			if(run->isSatisfied(required)) {
+				break;
+			}
+		}
+		if(run->claim(i)) {
+			run->runChild(i, *procedures[i]);
+		}
+	}
+
+	bool timedOut = false;
+	if(hasTimeout) {
+		std::unique_lock<std::mutex> lock(run->mutex);
+		timedOut = !run->endedCV.wait_until(lock, deadline, [&run, required]() {
+			return run->isSatisfied(required);
+		});
+	}
+	else {
+		/* Help instead of blocking: if this procedure runs on a worker of the same task factory,
+		 * the children might otherwise wait for a worker that never becomes free. */
+		for(std::size_t i = 0; i < size; ++i) {
+			{
+				std::lock_guard<std::mutex> lock(run->mutex);
+				if(run->isSatisfied(required)) {
+					break;
+				}
+			}
+			if(run->claim(i)) {
+				run->runChild(i, *procedures[i]);
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(run->mutex);
+		run->endedCV.wait(lock, [&run, required]() {
+			return run->isSatisfied(required);
+		});
+	}
+
+	/* Remaining children are not needed anymore. Unstarted children are skipped and their tasks get canceled.
+	 * Children that are still running are abandoned: they lose access to the caller's context and
+	 * their overlays are discarded when they end. */
+	for(std::size_t i = 0; i < size; ++i) {
+		run->claim(i);
+	}
+	{
+		std::lock_guard<std::mutex> lock(run->mutex);
+		run->decided = true;
+	}
+	for(std::size_t i = 0; i < size; ++i) {
+		run->overlays[i]->detach();
+	}
+	for(auto& task : tasks) {
+		esl::processing::Status status = task.getStatus();
+		if(status == esl::processing::Status::waiting) {
+			task.cancel();
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(runsMutex);
+		runs.erase(run.get());
+	}
+
+	/* overlays of children that have ended before the decision are not used by anyone else */
+	for(std::size_t i = 0; i < size; ++i) {
+		if(run->done[i]) {
+			run->overlays[i]->mergeInto(context);
+		}
+	}
+
+	if(run->succeeded >= required || run->canceled) {
+		return;
+	}
+
+	if(timedOut) {
+		throw std::runtime_error("Timeout after " + std::to_string(timeout.count()) + " ms: " + std::to_string(run->succeeded) + " of " + std::to_string(required) + " required procedures have finished.");
+	}
+
+	for(std::size_t i = 0; i < size; ++i) {
+		if(run->exceptions[i]) {
+			std::rethrow_exception(run->exceptions[i]);
+		}
+	}
+}
+
+void FanOut::procedureCancel() {
+	std::lock_guard<std::mutex> lock(runsMutex);
+	for(auto run : runs) {
+		std::lock_guard<std::mutex> runLock(run->mutex);
+		run->canceled = true;
+		run->endedCV.notify_all();
+	}
+}
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
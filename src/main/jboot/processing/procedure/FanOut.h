@@ -0,0 +1,86 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_PROCEDURE_FANOUT_H_
+#define JBOOT_PROCESSING_PROCEDURE_FANOUT_H_
+
+#include <esl/object/Context.h>
+#include <esl/object/InitializeContext.h>
+#include <esl/processing/Procedure.h>
+#include <esl/processing/TaskFactory.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+/* Runs all procedures given by 'procedure-id' concurrently as tasks of the task factory.
+ * Each procedure gets its own overlay of the caller's context: lookups fall through to the
+ * caller's context, added objects stay in the overlay. When enough procedures have finished,
+ * the objects of all successful procedures are moved into the caller's context in the order
+ * of their definition. If an object id exists already, the first one wins.
+ * Without 'timeout-ms' the caller runs children itself that no worker has started yet.
+ * With 'timeout-ms' the result is decided at the deadline at the latest. The call returns as soon as
+ * the result is decided: children that have not been started are skipped and running children are
+ * abandoned. They are not canceled, because their procedures are shared with other calls, but they
+ * cannot look up objects of the caller's context anymore and their added objects are discarded. */
+class FanOut : public esl::processing::Procedure, public esl::object::InitializeContext {
+public:
+	static std::unique_ptr<esl::processing::Procedure> create(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	FanOut(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	void initializeContext(esl::object::Context& context) override;
+
+	void procedureRun(esl::object::Context& context) override;
+	void procedureCancel() override;
+
+private:
+	class Overlay;
+	class Child;
+	struct Run;
+
+	std::vector<std::string> procedureIds;
+	std::vector<esl::processing::Procedure*> procedures;
+
+	std::string taskFactoryId;
+	esl::processing::TaskFactory* taskFactory = nullptr;
+
+	/* 0 means all procedures */
+	std::size_t waitFor = 0;
+
+	bool hasTimeout = false;
+	std::chrono::milliseconds timeout { 0 };
+
+	std::mutex runsMutex;
+	std::set<Run*> runs;
+};
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_PROCEDURE_FANOUT_H_ */
@@ -0,0 +1,149 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/procedure/Histogram.h>
+
+#include <limits>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+namespace {
+unsigned int log2Floor(std::uint64_t value) noexcept {
+	return 63 - static_cast<unsigned int>(__builtin_clzll(value));
+}
+} /* anonymous namespace */
+
+Histogram::Histogram()
+: counts(new std::atomic<std::uint64_t>[bucketsSize]),
+  minValue(std::numeric_limits<std::uint64_t>::max())
+{
+	reset();
+}
+
+void Histogram::record(std::uint64_t value) noexcept {
+	counts[getIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	totalCount.fetch_add(1, std::memory_order_relaxed);
+	totalValue.fetch_add(value, std::memory_order_relaxed);
+
+	std::uint64_t current = minValue.load(std::memory_order_relaxed);
+	while(value < current && !minValue.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+
+	current = maxValue.load(std::memory_order_relaxed);
+	while(value > current && !maxValue.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+}
+
+void Histogram::reset() noexcept {
+	for(std::size_t i = 0; i < bucketsSize; ++i) {
+		counts[i].store(0, std::memory_order_relaxed);
+	}
+	totalCount.store(0);
+	totalValue.store(0);
+	minValue.store(std::numeric_limits<std::uint64_t>::max());
+	maxValue.store(0);
+}
+
+std::uint64_t Histogram::getCount() const noexcept {
+	return totalCount.load();
+}
+
+std::uint64_t Histogram::getMin() const noexcept {
+	return getCount() == 0 ? 0 : minValue.load();
+}
+
+std::uint64_t Histogram::getMax() const noexcept {
+	return maxValue.load();
+}
+
+double Histogram::getMean() const noexcept {
+	std::uint64_t count = getCount();
+	return count == 0 ? 0.0 : static_cast<double>(totalValue.load()) / static_cast<double>(count);
+}
+
+std::uint64_t Histogram::getValueAtPercentile(double percentile) const noexcept {
+	std::uint64_t count = getCount();
+	if(count == 0) {
+		return 0;
+	}
+
+	if(percentile > 100.0) {
+		percentile = 100.0;
+	}
+	std::uint64_t countAtPercentile = static_cast<std::uint64_t>((percentile / 100.0) * static_cast<double>(count) + 0.5);
+	if(countAtPercentile == 0) {
+		countAtPercentile = 1;
+	}
+
+	std::uint64_t countTotal = 0;
+	for(std::size_t i = 0; i < bucketsSize; ++i) {
+		countTotal += counts[i].load(std::memory_order_relaxed);
+		if(countTotal >= countAtPercentile) {
+			std::uint64_t value = getHighestValue(i);
+			return value < getMax() ? value : getMax();
+		}
+	}
+
+	return getMax();
+}
+
+void Histogram::dumpPercentiles(std::ostream& oStream, double unitDivisor) const {
+	static const double percentiles[] = { 0.0, 50.0, 75.0, 90.0, 95.0, 99.0, 99.9, 99.99, 99.999, 100.0 };
+
+	for(double percentile : percentiles) {
+		std::uint64_t value = percentile == 0.0 ? getMin() : getValueAtPercentile(percentile);
+
+		/* number of recorded values up to and including the bucket of the value */
+		std::uint64_t countAtValue = 0;
+		const std::size_t valueIndex = getIndex(value);
+		for(std::size_t i = 0; i <= valueIndex && i < bucketsSize; ++i) {
+			countAtValue += counts[i].load(std::memory_order_relaxed);
+		}
+
+		oStream << percentile << " " << (static_cast<double>(value) / unitDivisor) << " " << countAtValue << "\n";
+	}
+}
+
+std::size_t Histogram::getIndex(std::uint64_t value) noexcept {
+	if(value < subBucketCount) {
+		return static_cast<std::size_t>(value);
+	}
+
+	unsigned int exponent = log2Floor(value) - subBucketBits + 1;
+	std::uint64_t subBucket = value >> exponent;
+	return static_cast<std::size_t>(subBucketCount + (exponent - 1) * subBucketHalfCount + (subBucket - subBucketHalfCount));
+}
+
+std::uint64_t Histogram::getHighestValue(std::size_t index) noexcept {
+	if(index < subBucketCount) {
+		return index;
+	}
+
+	std::size_t exponent = (index - subBucketCount) / subBucketHalfCount + 1;
+	std::uint64_t subBucket = (index - subBucketCount) % subBucketHalfCount + subBucketHalfCount;
+	if(exponent + subBucketBits - 1 >= 63) {
+		return std::numeric_limits<std::uint64_t>::max();
+	}
+	return ((subBucket + 1) << exponent) - 1;
+}
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
@@ -0,0 +1,73 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_PROCEDURE_HISTOGRAM_H_
+#define JBOOT_PROCESSING_PROCEDURE_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+/* Log-linear histogram in the style of HdrHistogram: every power of two is split
+ * into the same number of linear sub buckets, so the relative error of a recorded
+ * value is bounded (< 0.8% with 128 sub buckets, because the upper bound of a bucket is
+ * reported) independent of its magnitude. Recording is lock free. */
+class Histogram {
+public:
+	Histogram();
+
+	void record(std::uint64_t value) noexcept;
+	void reset() noexcept;
+
+	std::uint64_t getCount() const noexcept;
+	std::uint64_t getMin() const noexcept;
+	std::uint64_t getMax() const noexcept;
+	double getMean() const noexcept;
+	std::uint64_t getValueAtPercentile(double percentile) const noexcept;
+
+	/* prints a machine readable line per percentile: "<percentile> <value> <count>",
+	 * count is the number of recorded values up to the value */
+	void dumpPercentiles(std::ostream& oStream, double unitDivisor) const;
+
+private:
+	static constexpr unsigned int subBucketBits = 8;
+	static constexpr std::uint64_t subBucketCount = 1ull << subBucketBits;
+	static constexpr std::uint64_t subBucketHalfCount = subBucketCount / 2;
+	static constexpr unsigned int maxExponent = 64 - subBucketBits + 1;
+	static constexpr std::size_t bucketsSize = subBucketCount + maxExponent * subBucketHalfCount;
+
+	std::unique_ptr<std::atomic<std::uint64_t>[]> counts;
+	std::atomic<std::uint64_t> totalCount { 0 };
+	std::atomic<std::uint64_t> totalValue { 0 };
+	std::atomic<std::uint64_t> minValue;
+	std::atomic<std::uint64_t> maxValue { 0 };
+
+	static std::size_t getIndex(std::uint64_t value) noexcept;
+	static std::uint64_t getHighestValue(std::size_t index) noexcept;
+};
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_PROCEDURE_HISTOGRAM_H_ */
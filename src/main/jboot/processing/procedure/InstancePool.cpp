@@ -0,0 +1,203 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/procedure/InstancePool.h>
+
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+namespace {
+std::atomic<std::uint64_t> nextPoolId { 1 };
+} /* anonymous namespace */
+
+struct InstancePool::Instances {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<esl::processing::Procedure>> procedures;
+
+	/* the instance is destroyed without holding the lock */
+	void release(esl::processing::Procedure* instance) {
+		std::unique_ptr<esl::processing::Procedure> releasedInstance;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for(auto iter = procedures.begin(); iter != procedures.end(); ++iter) {
+				if(iter->get() == instance) {
+					releasedInstance = std::move(*iter);
+					procedures.erase(iter);
+					break;
+				}
+			}
+		}
+	}
+};
+
+/* pool id -> instance of the current thread. When the thread exits, its instances are handed back
+ * to the pools that still exist. */
+class InstancePool::ThreadInstances {
+public:
+	~ThreadInstances() {
+		for(auto& entry : entries) {
+			std::shared_ptr<Instances> instances = entry.second.instances.lock();
+			if(instances) {
+				instances->release(entry.second.instance);
+			}
+		}
+	}
+
+	esl::processing::Procedure* find(std::uint64_t poolId) const {
+		auto iter = entries.find(poolId);
+		return iter == entries.end() ? nullptr : iter->second.instance;
+	}
+
+	void add(std::uint64_t poolId, const std::shared_ptr<Instances>& instances, esl::processing::Procedure* instance) {
+		/* entries of destroyed pools are dropped, so threads that live longer than pools don't collect them */
+		for(auto iter = entries.begin(); iter != entries.end();) {
+			iter = iter->second.instances.expired() ? entries.erase(iter) : std::next(iter);
+		}
+		entries.emplace(poolId, Entry{instances, instance});
+	}
+
+	void erase(std::uint64_t poolId) {
+		entries.erase(poolId);
+	}
+
+private:
+	struct Entry {
+		std::weak_ptr<Instances> instances;
+		esl::processing::Procedure* instance;
+	};
+	std::unordered_map<std::uint64_t, Entry> entries;
+};
+
+thread_local InstancePool::ThreadInstances InstancePool::threadInstances;
+
+InstancePool::InstancePool(std::function<std::unique_ptr<esl::processing::Procedure>()> aCreate, Mode aMode, std::size_t poolSize)
+: create(std::move(aCreate)),
+  mode(aMode),
+  poolId(nextPoolId.fetch_add(1)),
+  instances(new Instances)
+{
+	if(mode == pool) {
+		if(poolSize == 0) {
+			throw std::runtime_error("Pool size of procedure instances must be > 0");
+		}
+		for(std::size_t i = 0; i < poolSize; ++i) {
+			instances->procedures.push_back(createInstance());
+			freeInstances.push_back(instances->procedures.back().get());
+		}
+	}
+}
+
+InstancePool::~InstancePool() {
+	if(mode == perThread) {
+		/* at least the entry of the destroying thread can be dropped */
+		threadInstances.erase(poolId);
+	}
+}
+
+void InstancePool::initializeContext(esl::object::Context& aContext) {
+	std::lock_guard<std::mutex> lock(instances->mutex);
+
+	context = &aContext;
+	for(auto& instance : instances->procedures) {
+		esl::object::InitializeContext* initializeContext = dynamic_cast<esl::object::InitializeContext*>(instance.get());
+		if(initializeContext) {
+			initializeContext->initializeContext(aContext);
+		}
+	}
+}
+
+void InstancePool::procedureRun(esl::object::Context& aContext) {
+	if(mode == perThread) {
+		getThreadInstance().procedureRun(aContext);
+		return;
+	}
+
+	esl::processing::Procedure* instance;
+	{
+		std::unique_lock<std::mutex> lock(instances->mutex);
+		freeCV.wait(lock, [this]() {
+			return !freeInstances.empty();
+		});
+		instance = freeInstances.back();
+		freeInstances.pop_back();
+	}
+
+	struct CheckIn {
+		~CheckIn() {
+			{
+				std::lock_guard<std::mutex> lock(instancePool.instances->mutex);
+				instancePool.freeInstances.push_back(instance);
+			}
+			instancePool.freeCV.notify_one();
+		}
+		InstancePool& instancePool;
+		esl::processing::Procedure* instance;
+	} checkIn{*this, instance};
+
+	instance->procedureRun(aContext);
+}
+
+void InstancePool::procedureCancel() {
+	std::lock_guard<std::mutex> lock(instances->mutex);
+	for(auto& instance : instances->procedures) {
+		instance->procedureCancel();
+	}
+}
+
+esl::processing::Procedure& InstancePool::getThreadInstance() {
+	esl::processing::Procedure* instancePtr = threadInstances.find(poolId);
+	if(instancePtr) {
+		return *instancePtr;
+	}
+
+	std::unique_ptr<esl::processing::Procedure> instance = createInstance();
+	instancePtr = instance.get();
+	{
+		std::lock_guard<std::mutex> lock(instances->mutex);
+
+		if(context) {
+			esl::object::InitializeContext* initializeContext = dynamic_cast<esl::object::InitializeContext*>(instancePtr);
+			if(initializeContext) {
+				initializeContext->initializeContext(*context);
+			}
+		}
+		instances->procedures.push_back(std::move(instance));
+	}
+
+	threadInstances.add(poolId, instances, instancePtr);
+	return *instancePtr;
+}
+
+std::unique_ptr<esl::processing::Procedure> InstancePool::createInstance() {
+	std::unique_ptr<esl::processing::Procedure> instance = create();
+	if(!instance) {
+		throw std::runtime_error("Could not create procedure instance because create function returns nullptr.");
+	}
+	return instance;
+}
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
@@ -0,0 +1,83 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_PROCEDURE_INSTANCEPOOL_H_
+#define JBOOT_PROCESSING_PROCEDURE_INSTANCEPOOL_H_
+
+#include <esl/object/Context.h>
+#include <esl/object/InitializeContext.h>
+#include <esl/processing/Procedure.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+/* Procedure that calls one of several instances of a procedure that is not thread safe.
+ * With 'perThread' every thread gets its own instance, created at its first call and destroyed
+ * when the thread exits.
+ * With 'pool' a fixed number of instances is created up front and a call checks out a
+ * free instance, waiting if all of them are in use. */
+class InstancePool : public esl::processing::Procedure, public esl::object::InitializeContext {
+public:
+	enum Mode {
+		perThread,
+		pool
+	};
+
+	InstancePool(std::function<std::unique_ptr<esl::processing::Procedure>()> create, Mode mode, std::size_t poolSize = 0);
+	~InstancePool();
+
+	void initializeContext(esl::object::Context& context) override;
+
+	void procedureRun(esl::object::Context& context) override;
+	void procedureCancel() override;
+
+private:
+	const std::function<std::unique_ptr<esl::processing::Procedure>()> create;
+	const Mode mode;
+
+	/* identifies this pool in the thread local instance cache, addresses might be reused */
+	const std::uint64_t poolId;
+
+	struct Instances;
+	class ThreadInstances;
+	static thread_local ThreadInstances threadInstances;
+
+	/* shared with the threads, so an exiting thread can release its instance after the pool has been destroyed */
+	std::shared_ptr<Instances> instances;
+	std::condition_variable freeCV;
+	std::vector<esl::processing::Procedure*> freeInstances;
+	esl::object::Context* context = nullptr;
+
+	esl::processing::Procedure& getThreadInstance();
+	std::unique_ptr<esl::processing::Procedure> createInstance();
+};
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_PROCEDURE_INSTANCEPOOL_H_ */
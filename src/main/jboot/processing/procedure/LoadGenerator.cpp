@@ -0,0 +1,404 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/procedure/LoadGenerator.h>
+#include <jboot/object/Context.h>
+#include <jboot/Logger.h>
+
+#include <esl/processing/Status.h>
+#include <esl/processing/TaskDescriptor.h>
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+namespace {
+Logger logger("jboot::processing::procedure::LoadGenerator");
+
+double toRate(const std::string& key, const std::string& value) {
+	double rate;
+	try {
+		rate = std::stod(value);
+	}
+	catch(...) {
+		throw std::runtime_error("Invalid value \"" + value + "\" for attribute '" + key + "'.");
+	}
+	if(rate < 0.0 || std::isnan(rate) || std::isinf(rate)) {
+		throw std::runtime_error("Invalid value \"" + value + "\" for attribute '" + key + "'. Value must be >= 0");
+	}
+	return rate;
+}
+
+std::chrono::milliseconds toMilliseconds(const std::string& key, const std::string& value) {
+	long ms;
+	try {
+		ms = std::stol(value);
+	}
+	catch(...) {
+		throw std::runtime_error("Invalid value \"" + value + "\" for attribute '" + key + "'.");
+	}
+	if(ms < 0) {
+		throw std::runtime_error("Invalid value \"" + value + "\" for attribute '" + key + "'. Value must be >= 0");
+	}
+	return std::chrono::milliseconds(ms);
+}
+} /* anonymous namespace */
+
+class LoadGenerator::Call : public esl::processing::Procedure {
+public:
+	Call(LoadGenerator& aLoadGenerator, std::chrono::steady_clock::time_point aScheduledTime, bool aRecordLatency)
+	: loadGenerator(aLoadGenerator),
+	  scheduledTime(aScheduledTime),
+	  recordLatency(aRecordLatency)
+	{ }
+
+	void procedureRun(esl::object::Context& context) override {
+		loadGenerator.runCall(context, scheduledTime, recordLatency);
+	}
+
+	void procedureCancel() override {
+		loadGenerator.procedure->procedureCancel();
+	}
+
+private:
+	LoadGenerator& loadGenerator;
+	std::chrono::steady_clock::time_point scheduledTime;
+	bool recordLatency;
+};
+
+std::unique_ptr<esl::processing::Procedure> LoadGenerator::create(const std::vector<std::pair<std::string, std::string>>& settings) {
+	return std::unique_ptr<esl::processing::Procedure>(new LoadGenerator(settings));
+}
+
+LoadGenerator::LoadGenerator(const std::vector<std::pair<std::string, std::string>>& settings) {
+	bool hasRate = false;
+	bool hasDuration = false;
+	bool hasWarmup = false;
+
+	for(const auto& setting : settings) {
+		if(setting.first == "procedure-id") {
+			if(!procedureId.empty()) {
+				throw std::runtime_error("multiple definition of attribute 'procedure-id'.");
+			}
+			procedureId = setting.second;
+			if(procedureId.empty()) {
+				throw std::runtime_error("Invalid value \"\" for attribute 'procedure-id'.");
+			}
+		}
+		else if(setting.first == "task-factory-id") {
+			if(!taskFactoryId.empty()) {
+				throw std::runtime_error("multiple definition of attribute 'task-factory-id'.");
+			}
+			taskFactoryId = setting.second;
+			if(taskFactoryId.empty()) {
+				throw std::runtime_error("Invalid value \"\" for attribute 'task-factory-id'.");
+			}
+		}
+		else if(setting.first == "rate") {
+			if(hasRate) {
+				throw std::runtime_error("multiple definition of attribute 'rate'.");
+			}
+			hasRate = true;
+			rateBegin = toRate(setting.first, setting.second);
+		}
+		else if(setting.first == "rate-end") {
+			if(hasRateEnd) {
+				throw std::runtime_error("multiple definition of attribute 'rate-end'.");
+			}
+			hasRateEnd = true;
+			rateEnd = toRate(setting.first, setting.second);
+		}
+		else if(setting.first == "duration-ms") {
+			if(hasDuration) {
+				throw std::runtime_error("multiple definition of attribute 'duration-ms'.");
+			}
+			hasDuration = true;
+			duration = toMilliseconds(setting.first, setting.second);
+		}
+		else if(setting.first == "warmup-ms") {
+			if(hasWarmup) {
+				throw std::runtime_error("multiple definition of attribute 'warmup-ms'.");
+			}
+			hasWarmup = true;
+			warmup = toMilliseconds(setting.first, setting.second);
+		}
+		else if(setting.first == "show-output") {
+			if(hasOutput) {
+				throw std::runtime_error("multiple definition of attribute 'show-output'.");
+			}
+			hasOutput = true;
+
+			if(setting.second == "stdout") {
+				output = stdOut;
+			}
+			else if(setting.second == "stderr") {
+				output = stdErr;
+			}
+			else if(setting.second == "trace") {
+				output = logTrace;
+			}
+			else if(setting.second == "debug") {
+				output = logDebug;
+			}
+			else if(setting.second == "info") {
+				output = logInfo;
+			}
+			else if(setting.second == "warn") {
+				output = logWarn;
+			}
+			else if(setting.second == "error") {
+				output = logError;
+			}
+			else {
+				throw std::runtime_error("Invalid value \"" + setting.second + "\" for attribute 'show-output'");
+			}
+		}
+		else {
+			throw std::runtime_error("unknown attribute '\"" + setting.first + "\"'.");
+		}
+	}
+
+	if(procedureId.empty()) {
+		throw std::runtime_error("Definition of 'procedure-id' is missing.");
+	}
+	if(!hasRate) {
+		throw std::runtime_error("Definition of 'rate' is missing.");
+	}
+	if(!hasDuration) {
+		throw std::runtime_error("Definition of 'duration-ms' is missing.");
+	}
+	if(warmup.count() + duration.count() == 0) {
+		throw std::runtime_error("Invalid definition of 'duration-ms' = 0 without 'warmup-ms'. Total duration must be > 0.");
+	}
+	if(rateBegin == 0.0 && (!hasRateEnd || rateEnd == 0.0)) {
+		throw std::runtime_error("Definition of 'rate' = 0 is only allowed together with a definition of 'rate-end' > 0.");
+	}
+}
+
+void LoadGenerator::initializeContext(esl::object::Context& context) {
+	procedure = context.findObject<esl::processing::Procedure>(procedureId);
+	if(procedure == nullptr) {
+		throw std::runtime_error("Cannot find procedure with id '" + procedureId + "'.");
+	}
+
+	if(!taskFactoryId.empty()) {
+		taskFactory = context.findObject<esl::processing::TaskFactory>(taskFactoryId);
+		if(taskFactory == nullptr) {
+			throw std::runtime_error("Cannot find task factory with id '" + taskFactoryId + "'.");
+		}
+	}
+}
+
+void LoadGenerator::procedureRun(esl::object::Context&) {
+	if(procedure == nullptr) {
+		throw std::runtime_error("Load generator has not been initialized. Procedure with id '" + procedureId + "' is not available.");
+	}
+
+	canceled.store(false);
+	histogram.reset();
+	callsIssued.store(0);
+	callsFailed.store(0);
+
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point measureTime = startTime + warmup;
+	const std::chrono::nanoseconds totalDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(warmup + duration);
+
+	/* calls that have been issued already must have finished before an exception of createTask is rethrown */
+	std::exception_ptr createTaskException;
+
+	for(std::uint64_t callNumber = 0; !canceled.load(); ++callNumber) {
+		std::chrono::nanoseconds scheduledOffset = getScheduledOffset(callNumber);
+		if(scheduledOffset >= totalDuration) {
+			break;
+		}
+
+		/* With a task factory we don't wait for previous calls. Without one, calls run back to back on
+		 * this thread. Either way, if we are behind schedule the time a call has been delayed is part
+		 * of its latency. */
+		std::chrono::steady_clock::time_point scheduledTime = startTime + scheduledOffset;
+		std::this_thread::sleep_until(scheduledTime);
+
+		bool recordLatency = scheduledTime >= measureTime;
+		if(recordLatency) {
+			++callsIssued;
+		}
+
+		if(taskFactory) {
+			{
+				std::lock_guard<std::mutex> lockOutstanding(outstandingMutex);
+				++outstanding;
+			}
+
+			esl::processing::TaskDescriptor descriptor;
+			descriptor.procedure.reset(new Call(*this, scheduledTime, recordLatency));
+			descriptor.onStateChanged = [this](esl::processing::Status status) {
+				if(status == esl::processing::Status::done || status == esl::processing::Status::exception || status == esl::processing::Status::canceled) {
+					std::lock_guard<std::mutex> lockOutstanding(outstandingMutex);
+					--outstanding;
+					outstandingCV.notify_all();
+				}
+			};
+			try {
+				taskFactory->createTask(std::move(descriptor));
+			}
+			catch(...) {
+				std::lock_guard<std::mutex> lockOutstanding(outstandingMutex);
+				--outstanding;
+				createTaskException = std::current_exception();
+				break;
+			}
+		}
+		else {
+			object::Context callContext;
+			runCall(callContext, scheduledTime, recordLatency);
+		}
+	}
+
+	{
+		std::unique_lock<std::mutex> lockOutstanding(outstandingMutex);
+		outstandingCV.wait(lockOutstanding, [this]() {
+			return outstanding == 0;
+		});
+	}
+
+	if(createTaskException) {
+		std::rethrow_exception(createTaskException);
+	}
+
+	std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds elapsed = endTime > measureTime ? endTime - measureTime : std::chrono::nanoseconds(0);
+
+	switch(output) {
+	case stdOut:
+		printReport(std::cout, elapsed);
+		break;
+	case stdErr:
+		printReport(std::cerr, elapsed);
+		break;
+	default: {
+		std::stringstream strStream;
+		printReport(strStream, elapsed);
+		if(output == logTrace) {
+			logger.trace << strStream.str();
+		}
+		else if(output == logDebug) {
+			logger.debug << strStream.str();
+		}
+		else if(output == logInfo) {
+			logger.info << strStream.str();
+		}
+		else if(output == logWarn) {
+			logger.warn << strStream.str();
+		}
+		else {
+			logger.error << strStream.str();
+		}
+		break;
+	}
+	}
+}
+
+void LoadGenerator::procedureCancel() {
+	canceled.store(true);
+}
+
+std::chrono::nanoseconds LoadGenerator::getScheduledOffset(std::uint64_t callNumber) const {
+	/* number of calls until time t for a rate that changes linearly from rateBegin to rateEnd:
+	 *   n(t) = rateBegin * t + (rateEnd - rateBegin) * t^2 / (2 * T)
+	 * The scheduled time of call "callNumber" is the solution of n(t) = callNumber. */
+	const double totalSeconds = std::chrono::duration<double>(warmup + duration).count();
+	const double n = static_cast<double>(callNumber);
+	double seconds;
+
+	if(!hasRateEnd || rateEnd == rateBegin || totalSeconds <= 0.0) {
+		if(rateBegin <= 0.0) {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(warmup + duration);
+		}
+		seconds = n / rateBegin;
+	}
+	else {
+		double a = (rateEnd - rateBegin) / (2.0 * totalSeconds);
+		double discriminant = rateBegin * rateBegin + 4.0 * a * n;
+		if(discriminant < 0.0) {
+			/* rate drops to zero before the end of the run */
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(warmup + duration);
+		}
+		seconds = (std::sqrt(discriminant) - rateBegin) / (2.0 * a);
+	}
+
+	return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(seconds * 1e9));
+}
+
+void LoadGenerator::runCall(esl::object::Context& context, std::chrono::steady_clock::time_point scheduledTime, bool recordLatency) {
+	bool failed = false;
+
+	try {
+		procedure->procedureRun(context);
+	}
+	catch(...) {
+		failed = true;
+	}
+
+	if(recordLatency) {
+		std::chrono::nanoseconds latency = std::chrono::steady_clock::now() - scheduledTime;
+		histogram.record(latency.count() < 0 ? 0 : static_cast<std::uint64_t>(latency.count()));
+		if(failed) {
+			++callsFailed;
+		}
+	}
+}
+
+void LoadGenerator::printReport(std::ostream& oStream, std::chrono::nanoseconds elapsed) const {
+	const double seconds = std::chrono::duration<double>(elapsed).count();
+	const std::uint64_t callsCompleted = histogram.getCount();
+
+	oStream << "Load generator report for procedure \"" << procedureId << "\"\n";
+	oStream << "  Mode             : " << (taskFactory ? "task factory \"" + taskFactoryId + "\"" : std::string("inline")) << "\n";
+	oStream << "  Rate (calls/s)   : " << rateBegin;
+	if(hasRateEnd) {
+		oStream << " -> " << rateEnd;
+	}
+	oStream << "\n";
+	oStream << "  Duration (s)     : " << seconds << "\n";
+	oStream << "  Calls issued     : " << callsIssued.load() << "\n";
+	oStream << "  Calls completed  : " << callsCompleted << "\n";
+	oStream << "  Calls failed     : " << callsFailed.load() << "\n";
+	oStream << "  Throughput (1/s) : " << (seconds > 0.0 ? static_cast<double>(callsCompleted) / seconds : 0.0) << "\n";
+	oStream << "  Latency (ms, corrected for coordinated omission)\n";
+	oStream << "    min    : " << static_cast<double>(histogram.getMin()) / 1e6 << "\n";
+	oStream << "    mean   : " << histogram.getMean() / 1e6 << "\n";
+	oStream << "    p50    : " << static_cast<double>(histogram.getValueAtPercentile(50.0)) / 1e6 << "\n";
+	oStream << "    p90    : " << static_cast<double>(histogram.getValueAtPercentile(90.0)) / 1e6 << "\n";
+	oStream << "    p99    : " << static_cast<double>(histogram.getValueAtPercentile(99.0)) / 1e6 << "\n";
+	oStream << "    p99.9  : " << static_cast<double>(histogram.getValueAtPercentile(99.9)) / 1e6 << "\n";
+	oStream << "    p99.99 : " << static_cast<double>(histogram.getValueAtPercentile(99.99)) / 1e6 << "\n";
+	oStream << "    max    : " << static_cast<double>(histogram.getMax()) / 1e6 << "\n";
+	oStream << "  Percentile distribution (percentile latency-ms count):\n";
+	histogram.dumpPercentiles(oStream, 1e6);
+}
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
@@ -0,0 +1,104 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_PROCEDURE_LOADGENERATOR_H_
+#define JBOOT_PROCESSING_PROCEDURE_LOADGENERATOR_H_
+
+#include <jboot/processing/procedure/Histogram.h>
+
+#include <esl/object/Context.h>
+#include <esl/object/InitializeContext.h>
+#include <esl/processing/Procedure.h>
+#include <esl/processing/TaskFactory.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace processing {
+namespace procedure {
+
+/* Open loop load generator: calls are issued at their scheduled time, independent of
+ * how long previous calls took. Latency is measured from the scheduled start time
+ * instead of the actual start time to correct for coordinated omission. */
+class LoadGenerator : public esl::processing::Procedure, public esl::object::InitializeContext {
+public:
+	static std::unique_ptr<esl::processing::Procedure> create(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	LoadGenerator(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	void initializeContext(esl::object::Context& context) override;
+
+	void procedureRun(esl::object::Context& context) override;
+	void procedureCancel() override;
+
+private:
+	class Call;
+
+	std::string procedureId;
+	esl::processing::Procedure* procedure = nullptr;
+
+	std::string taskFactoryId;
+	esl::processing::TaskFactory* taskFactory = nullptr;
+
+	bool hasRateEnd = false;
+	double rateBegin = 0.0;
+	double rateEnd = 0.0;
+	std::chrono::milliseconds duration { 0 };
+	std::chrono::milliseconds warmup { 0 };
+
+	enum Output {
+		stdOut,
+		stdErr,
+		logTrace,
+		logDebug,
+		logInfo,
+		logWarn,
+		logError
+	};
+	bool hasOutput = false;
+	Output output = stdOut;
+
+	std::atomic<bool> canceled { false };
+
+	Histogram histogram;
+	std::atomic<std::uint64_t> callsIssued { 0 };
+	std::atomic<std::uint64_t> callsFailed { 0 };
+
+	std::mutex outstandingMutex;
+	std::condition_variable outstandingCV;
+	std::size_t outstanding = 0;
+
+	std::chrono::nanoseconds getScheduledOffset(std::uint64_t callNumber) const;
+	void runCall(esl::object::Context& context, std::chrono::steady_clock::time_point scheduledTime, bool recordLatency);
+	void printReport(std::ostream& oStream, std::chrono::nanoseconds elapsed) const;
+};
+
+} /* namespace procedure */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_PROCEDURE_LOADGENERATOR_H_ */
@@ -24,10 +24,11 @@ namespace jboot {
 namespace processing {
 namespace task {
 
-Binding::Binding(TaskFactory& aTaskFactory, esl::processing::TaskDescriptor aDescriptor)
+Binding::Binding(TaskFactory& aTaskFactory, esl::processing::TaskDescriptor aDescriptor, std::uint64_t aWalId)
 : taskFactory(&aTaskFactory),
   descriptor(std::move(aDescriptor)),
-  event(dynamic_cast<esl::object::Event*>(descriptor.procedure.get()))
+  event(dynamic_cast<esl::object::Event*>(descriptor.procedure.get())),
+  walId(aWalId)
 { }
 
 void Binding::sendEvent(const esl::object::Object& object) {
@@ -37,23 +38,36 @@ void Binding::sendEvent(const esl::object::Object& object) {
 }
 
 void Binding::cancel() {
-	std::lock_guard<std::mutex> lockTaskFactory(taskFactoryMutex);
+	std::unique_lock<std::mutex> lockTaskFactory(taskFactoryMutex);
 
 	if(taskFactory == nullptr) {
 		return;
 	}
 
+	bool removed = false;
 	{
 		std::lock_guard<std::mutex> lockQueueMutext(taskFactory->queueMutex);
 		for(auto iter = taskFactory->queue.begin(); iter != taskFactory->queue.end(); ++iter) {
 			if(iter->first == this) {
 				taskFactory->queue.erase(iter);
-				setStatus(esl::processing::Status::canceled);
-				return;
+				removed = true;
+				break;
 			}
 		}
 	}
 
+	if(removed) {
+		if(walId != 0 && taskFactory->writeAheadLog) {
+			taskFactory->writeAheadLog->complete(walId, esl::processing::Status::canceled);
+		}
+		taskFactory = nullptr;
+
+		/* setStatus(canceled) locks taskFactoryMutex again */
+		lockTaskFactory.unlock();
+		setStatus(esl::processing::Status::canceled);
+		return;
+	}
+
 	if(descriptor.procedure) {
 		std::lock_guard<std::mutex> lockThreadsMutext(taskFactory->threadsMutex);
 		if(taskFactory->threadsProcessing.count(this) != 0) {
@@ -117,6 +131,9 @@ void Binding::run() noexcept {
 	}
 
 	std::lock_guard<std::mutex> lockTaskFactory(taskFactoryMutex);
+	if(walId != 0 && taskFactory && taskFactory->writeAheadLog) {
+		taskFactory->writeAheadLog->complete(walId, getStatus());
+	}
 	taskFactory = nullptr;
 }
 
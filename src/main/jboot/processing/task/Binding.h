@@ -26,6 +26,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <memory>
@@ -46,7 +47,7 @@ public:
 	friend class Thread;
 	friend class Task;
 
-	Binding(TaskFactory& taskFactory, esl::processing::TaskDescriptor descriptor);
+	Binding(TaskFactory& taskFactory, esl::processing::TaskDescriptor descriptor, std::uint64_t walId = 0);
 
 	void sendEvent(const esl::object::Object& object) override;
 	void cancel() override;
@@ -67,6 +68,9 @@ private:
 	esl::processing::TaskDescriptor descriptor;
 	esl::object::Event* event = nullptr;
 
+	/* id of the task in the write ahead log of the TaskFactory or 0 if the task is not persistent */
+	const std::uint64_t walId;
+
 	std::atomic<esl::processing::Status> status { esl::processing::Status::waiting };
 	std::exception_ptr exceptionPtr;
 };
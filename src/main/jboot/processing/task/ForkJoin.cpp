@@ -0,0 +1,164 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/task/ForkJoin.h>
+
+#include <esl/processing/Procedure.h>
+#include <esl/processing/Status.h>
+#include <esl/processing/Task.h>
+#include <esl/processing/TaskDescriptor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+namespace {
+struct State {
+	State(std::size_t aChunks, std::function<void(std::size_t)> aFunction)
+	: chunks(aChunks),
+	  function(std::move(aFunction))
+	{ }
+
+	const std::size_t chunks;
+	const std::function<void(std::size_t)> function;
+
+	std::atomic<std::size_t> nextChunk { 0 };
+	std::atomic<bool> failed { false };
+
+	std::mutex mutex;
+	std::condition_variable finishedCV;
+	std::size_t finished = 0;
+	std::exception_ptr exceptionPtr;
+
+	void runChunks() {
+		std::size_t count = 0;
+
+		for(std::size_t chunk = nextChunk.fetch_add(1); chunk < chunks; chunk = nextChunk.fetch_add(1)) {
+			++count;
+			if(failed.load()) {
+				continue;
+			}
+
+			try {
+				function(chunk);
+			}
+			catch(...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if(!exceptionPtr) {
+					exceptionPtr = std::current_exception();
+				}
+				failed.store(true);
+			}
+		}
+
+		if(count > 0) {
+			std::lock_guard<std::mutex> lock(mutex);
+			finished += count;
+			if(finished == chunks) {
+				finishedCV.notify_all();
+			}
+		}
+	}
+};
+
+class Helper : public esl::processing::Procedure {
+public:
+	Helper(std::shared_ptr<State> aState)
+	: state(std::move(aState))
+	{ }
+
+	void procedureRun(esl::object::Context&) override {
+		state->runChunks();
+	}
+
+	void procedureCancel() override {
+	}
+
+private:
+	/* shared, because a helper might start after the caller has returned */
+	std::shared_ptr<State> state;
+};
+
+std::size_t getHardwareThreads() {
+	std::size_t hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads == 0 ? 1 : hardwareThreads;
+}
+} /* anonymous namespace */
+
+void ForkJoin::run(esl::processing::TaskFactory& taskFactory, std::size_t chunks, std::function<void(std::size_t)> function, std::size_t helpers) {
+	if(chunks == 0) {
+		return;
+	}
+
+	std::shared_ptr<State> state(new State(chunks, std::move(function)));
+
+	if(helpers == 0) {
+		helpers = getHardwareThreads();
+	}
+	helpers = std::min(helpers, chunks - 1);
+
+	std::vector<esl::processing::Task> tasks;
+	for(std::size_t i = 0; i < helpers; ++i) {
+		esl::processing::TaskDescriptor descriptor;
+		descriptor.procedure.reset(new Helper(state));
+		try {
+			tasks.push_back(taskFactory.createTask(std::move(descriptor)));
+		}
+		catch(...) {
+			/* the calling thread does the remaining work */
+			break;
+		}
+	}
+
+	state->runChunks();
+
+	/* all chunks are taken now. Helpers that have not been started yet have nothing left to do. */
+	for(auto& task : tasks) {
+		if(task.getStatus() == esl::processing::Status::waiting) {
+			task.cancel();
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finishedCV.wait(lock, [&state]() {
+		return state->finished == state->chunks;
+	});
+
+	if(state->exceptionPtr) {
+		std::rethrow_exception(state->exceptionPtr);
+	}
+}
+
+std::size_t ForkJoin::getChunks(std::size_t size, std::size_t& chunkSize) {
+	if(chunkSize == 0) {
+		chunkSize = std::max<std::size_t>(1, size / (4 * getHardwareThreads()));
+	}
+	return (size + chunkSize - 1) / chunkSize;
+}
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
@@ -0,0 +1,100 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_TASK_FORKJOIN_H_
+#define JBOOT_PROCESSING_TASK_FORKJOIN_H_
+
+#include <esl/processing/TaskFactory.h>
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+/* Data parallel loops for procedures on top of any esl::processing::TaskFactory.
+ * A range is split into chunks. Helper tasks and the calling thread take chunks from a shared
+ * counter, so the caller never waits for a chunk that has not been started yet. That's why it is
+ * safe to call these functions from a procedure running on the same TaskFactory, even if all
+ * threads of the factory are busy. */
+class ForkJoin final {
+public:
+	ForkJoin() = delete;
+
+	/* Calls function(chunkIndex) for each chunkIndex in [0, chunks) and returns when all calls are done.
+	 * At most 'helpers' tasks are created on taskFactory, 0 means one per hardware thread.
+	 * The first exception thrown by 'function' is rethrown, remaining chunks are skipped then. */
+	static void run(esl::processing::TaskFactory& taskFactory, std::size_t chunks, std::function<void(std::size_t)> function, std::size_t helpers = 0);
+
+	/* Returns the number of chunks for a range of 'size' elements. Chunk size 0 selects a chunk size
+	 * that gives a few chunks per hardware thread. */
+	static std::size_t getChunks(std::size_t size, std::size_t& chunkSize);
+
+	/* Calls function(first, last) for sub-ranges [first, last) of [begin, end) */
+	template<typename Index, typename Function>
+	static void parallelFor(esl::processing::TaskFactory& taskFactory, Index begin, Index end, Function function, std::size_t chunkSize = 0) {
+		if(!(begin < end)) {
+			return;
+		}
+
+		std::size_t chunks = getChunks(static_cast<std::size_t>(end - begin), chunkSize);
+		run(taskFactory, chunks, [&](std::size_t chunk) {
+			Index first = begin + static_cast<Index>(chunk * chunkSize);
+			Index last = (chunk + 1 == chunks) ? end : first + static_cast<Index>(chunkSize);
+			function(first, last);
+		});
+	}
+
+	/* Calls map(first, last) for sub-ranges [first, last) of [begin, end) and combines the results
+	 * with reduce(a, b) in the order of the sub-ranges, so a reduce function that is associative
+	 * but not commutative gives the same result as a sequential loop. */
+	template<typename T, typename Index, typename Map, typename Reduce>
+	static T parallelReduce(esl::processing::TaskFactory& taskFactory, Index begin, Index end, T identity, Map map, Reduce reduce, std::size_t chunkSize = 0) {
+		if(!(begin < end)) {
+			return identity;
+		}
+
+		/* wrapped, because concurrent writes to different elements of std::vector<bool> are a data race */
+		struct PartialResult {
+			T value;
+		};
+
+		std::size_t chunks = getChunks(static_cast<std::size_t>(end - begin), chunkSize);
+		std::vector<PartialResult> results(chunks, PartialResult{identity});
+		run(taskFactory, chunks, [&](std::size_t chunk) {
+			Index first = begin + static_cast<Index>(chunk * chunkSize);
+			Index last = (chunk + 1 == chunks) ? end : first + static_cast<Index>(chunkSize);
+			results[chunk].value = map(first, last);
+		});
+
+		T result = std::move(identity);
+		for(auto& partialResult : results) {
+			result = reduce(std::move(result), std::move(partialResult.value));
+		}
+		return result;
+	}
+};
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_TASK_FORKJOIN_H_ */
@@ -0,0 +1,76 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/task/ProcedureReference.h>
+
+#include <esl/object/Value.h>
+
+#include <memory>
+#include <stdexcept>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+ProcedureReference::ProcedureReference(std::string aId, std::vector<std::pair<std::string, std::string>> aSettings)
+: id(std::move(aId)),
+  settings(std::move(aSettings))
+{ }
+
+const std::string& ProcedureReference::getId() const noexcept {
+	return id;
+}
+
+const std::vector<std::pair<std::string, std::string>>& ProcedureReference::getSettings() const noexcept {
+	return settings;
+}
+
+void ProcedureReference::resolve(esl::object::Context& context) {
+	procedure = context.findObject<esl::processing::Procedure>(id);
+	if(procedure == nullptr) {
+		throw std::runtime_error("Cannot resolve procedure reference, because there is no procedure with id '" + id + "'.");
+	}
+}
+
+bool ProcedureReference::isResolved() const noexcept {
+	return procedure != nullptr;
+}
+
+void ProcedureReference::procedureRun(esl::object::Context& context) {
+	if(procedure == nullptr) {
+		throw std::runtime_error("Procedure reference to id '" + id + "' has not been resolved.");
+	}
+
+	for(const auto& setting : settings) {
+		if(context.findObject<esl::object::Object>(setting.first) == nullptr) {
+			context.addObject(setting.first, std::unique_ptr<esl::object::Value<std::string>>(new esl::object::Value<std::string>(setting.second)));
+		}
+	}
+
+	procedure->procedureRun(context);
+}
+
+void ProcedureReference::procedureCancel() {
+	if(procedure) {
+		procedure->procedureCancel();
+	}
+}
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
@@ -0,0 +1,60 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_TASK_PROCEDUREREFERENCE_H_
+#define JBOOT_PROCESSING_TASK_PROCEDUREREFERENCE_H_
+
+#include <esl/object/Context.h>
+#include <esl/processing/Procedure.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+/* Procedure that refers to a procedure of the boot context by its id.
+ * Other than a procedure object it can be transferred to another process or written to disk,
+ * because it consists of the id and the settings only. Settings are added as
+ * esl::object::Value<std::string> to the context the referenced procedure is running with. */
+class ProcedureReference : public esl::processing::Procedure {
+public:
+	ProcedureReference(std::string id, std::vector<std::pair<std::string, std::string>> settings = {});
+
+	const std::string& getId() const noexcept;
+	const std::vector<std::pair<std::string, std::string>>& getSettings() const noexcept;
+
+	void resolve(esl::object::Context& context);
+	bool isResolved() const noexcept;
+
+	void procedureRun(esl::object::Context& context) override;
+	void procedureCancel() override;
+
+private:
+	std::string id;
+	std::vector<std::pair<std::string, std::string>> settings;
+	esl::processing::Procedure* procedure = nullptr;
+};
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_TASK_PROCEDUREREFERENCE_H_ */
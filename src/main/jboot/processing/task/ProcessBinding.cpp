@@ -0,0 +1,113 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/task/ProcessBinding.h>
+#include <jboot/processing/task/ProcessTaskFactory.h>
+#include <jboot/object/Context.h>
+
+#include <stdexcept>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+ProcessBinding::ProcessBinding(ProcessTaskFactory& aTaskFactory, esl::processing::TaskDescriptor aDescriptor, std::uint64_t aId)
+: taskFactory(&aTaskFactory),
+  descriptor(std::move(aDescriptor)),
+  id(aId)
+{
+	if(dynamic_cast<ProcedureReference*>(descriptor.procedure.get()) == nullptr) {
+		throw std::runtime_error("Tasks of a process task factory require a procedure of type jboot::processing::task::ProcedureReference.");
+	}
+	if(!descriptor.context) {
+		descriptor.context.reset(new object::Context);
+	}
+}
+
+void ProcessBinding::sendEvent(const esl::object::Object&) {
+	/* events cannot be transferred to a worker process */
+}
+
+void ProcessBinding::cancel() {
+	{
+		std::lock_guard<std::mutex> lockTaskFactory(taskFactoryMutex);
+
+		/* returns false if the task is running already. Then the worker process gets a cancel request. */
+		if(taskFactory == nullptr || taskFactory->cancel(*this) == false) {
+			return;
+		}
+		taskFactory = nullptr;
+	}
+
+	setStatus(esl::processing::Status::canceled);
+}
+
+esl::processing::Status ProcessBinding::getStatus() const {
+	return status.load();
+}
+
+esl::object::Context* ProcessBinding::getContext() const {
+	switch(getStatus()) {
+	case esl::processing::Status::canceled:
+	case esl::processing::Status::exception:
+	case esl::processing::Status::done:
+		return descriptor.context.get();
+	default:
+		break;
+	}
+	return nullptr;
+}
+
+std::exception_ptr ProcessBinding::getException() const {
+	return exceptionPtr;
+}
+
+std::uint64_t ProcessBinding::getId() const noexcept {
+	return id;
+}
+
+const ProcedureReference& ProcessBinding::getProcedureReference() const {
+	return *static_cast<ProcedureReference*>(descriptor.procedure.get());
+}
+
+void ProcessBinding::setStatus(esl::processing::Status aStatus) {
+	if(status.exchange(aStatus) == aStatus) {
+		return;
+	}
+
+	if(descriptor.onStateChanged) {
+		try {
+			descriptor.onStateChanged(aStatus);
+		}
+		catch(...) {
+		}
+	}
+}
+
+void ProcessBinding::setException(std::exception_ptr aExceptionPtr) {
+	exceptionPtr = aExceptionPtr;
+}
+
+void ProcessBinding::release() {
+	std::lock_guard<std::mutex> lockTaskFactory(taskFactoryMutex);
+	taskFactory = nullptr;
+}
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
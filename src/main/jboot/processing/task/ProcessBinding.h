@@ -0,0 +1,75 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_TASK_PROCESSBINDING_H_
+#define JBOOT_PROCESSING_TASK_PROCESSBINDING_H_
+
+#include <jboot/processing/task/ProcedureReference.h>
+
+#include <esl/object/Context.h>
+#include <esl/object/Object.h>
+#include <esl/processing/Status.h>
+#include <esl/processing/Task.h>
+#include <esl/processing/TaskDescriptor.h>
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+class ProcessTaskFactory;
+
+class ProcessBinding final : public esl::processing::Task::Binding {
+public:
+	ProcessBinding(ProcessTaskFactory& taskFactory, esl::processing::TaskDescriptor descriptor, std::uint64_t id);
+
+	void sendEvent(const esl::object::Object& object) override;
+	void cancel() override;
+
+	esl::processing::Status getStatus() const override;
+	esl::object::Context* getContext() const override;
+	std::exception_ptr getException() const override;
+
+	std::uint64_t getId() const noexcept;
+	const ProcedureReference& getProcedureReference() const;
+
+	/* called by ProcessTaskFactory */
+	void setStatus(esl::processing::Status status);
+	void setException(std::exception_ptr exceptionPtr);
+	void release();
+
+private:
+	mutable std::mutex taskFactoryMutex;
+	ProcessTaskFactory* taskFactory;
+
+	esl::processing::TaskDescriptor descriptor;
+	const std::uint64_t id;
+
+	std::atomic<esl::processing::Status> status { esl::processing::Status::waiting };
+	std::exception_ptr exceptionPtr;
+};
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_TASK_PROCESSBINDING_H_ */
@@ -0,0 +1,390 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/task/ProcessTaskFactory.h>
+#include <jboot/Logger.h>
+
+#include <esl/processing/Status.h>
+#include <esl/system/Stacktrace.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+namespace {
+Logger logger("jboot::processing::task::ProcessTaskFactory");
+} /* anonymous namespace */
+
+std::unique_ptr<esl::processing::TaskFactory> ProcessTaskFactory::create(const std::vector<std::pair<std::string, std::string>>& settings) {
+	return std::unique_ptr<esl::processing::TaskFactory>(new ProcessTaskFactory(settings));
+}
+
+ProcessTaskFactory::ProcessTaskFactory(const std::vector<std::pair<std::string, std::string>>& settings) {
+    for(const auto& setting : settings) {
+		if(setting.first == "processes") {
+			if(processesMax > 0) {
+		        throw std::runtime_error("multiple definition of attribute 'processes'.");
+			}
+
+			int tmpProcesses;
+			try {
+				tmpProcesses = std::stoi(setting.second);
+			}
+			catch(...) {
+	            throw std::runtime_error("jboot: Invalid value \"" + setting.second + "\" for attribute 'processes'.");
+			}
+
+			if(tmpProcesses <= 0 || tmpProcesses > 1000) {
+	            throw std::runtime_error("jboot: Invalid value \"" + std::to_string(tmpProcesses) + "\" for attribute 'processes'. Value has to be between 1 and 1000.");
+			}
+			processesMax = static_cast<unsigned int>(tmpProcesses);
+		}
+		else {
+            throw std::runtime_error("unknown attribute '\"" + setting.first + "\"'.");
+		}
+    }
+
+	if(processesMax == 0) {
+        throw std::runtime_error("Definition of 'processes' is missing.");
+	}
+
+	if(::pipe2(wakeupFds, O_CLOEXEC | O_NONBLOCK) != 0) {
+		throw esl::system::Stacktrace::add(std::runtime_error(std::string("Cannot create wakeup pipe: ") + std::strerror(errno)));
+	}
+}
+
+ProcessTaskFactory::~ProcessTaskFactory() {
+	std::list<std::shared_ptr<ProcessBinding>> queueCanceled;
+	std::vector<std::shared_ptr<ProcessBinding>> bindingsRunning;
+
+	if(afterInitialize) {
+		afterInitialize->cancelAfterInitialize(this);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		queueCanceled = std::move(queue);
+		queue.clear();
+	}
+
+	wakeup();
+	if(dispatcherThread.joinable()) {
+		dispatcherThread.join();
+	}
+
+	for(auto& binding : queueCanceled) {
+		binding->release();
+		binding->setStatus(esl::processing::Status::canceled);
+	}
+
+	for(auto& worker : workers) {
+		if(worker && worker->binding) {
+			bindingsRunning.push_back(std::move(worker->binding));
+		}
+	}
+
+	/* closes the sockets and waits for the worker processes and the template process to terminate */
+	workers.clear();
+	processTemplate.reset();
+
+	for(auto& binding : bindingsRunning) {
+		binding->release();
+		binding->setStatus(esl::processing::Status::canceled);
+	}
+
+	::close(wakeupFds[0]);
+	::close(wakeupFds[1]);
+}
+
+void ProcessTaskFactory::initializeContext(esl::object::Context& aContext) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(context) {
+			return;
+		}
+		context = &aContext;
+	}
+
+	/* Workers are not forked right now, because the objects of the boot context are initialized
+	 * after this factory. So each worker gets a copy of the completely initialized boot context. */
+	afterInitialize = dynamic_cast<object::AfterInitialize*>(&aContext);
+	if(afterInitialize) {
+		afterInitialize->runAfterInitialize(this, [this]() {
+			start();
+		});
+	}
+	else {
+		start();
+	}
+}
+
+esl::processing::Task ProcessTaskFactory::createTask(esl::processing::TaskDescriptor descriptor) {
+	std::shared_ptr<ProcessBinding> binding;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(stopping) {
+	        throw std::runtime_error("Cannot create task because process task factory is shutting down.");
+		}
+
+		if(!context) {
+	        throw std::runtime_error("Cannot create task because process task factory has not been initialized.");
+		}
+
+		/* tasks created before the workers have been started wait in the queue */
+		binding = std::make_shared<ProcessBinding>(*this, std::move(descriptor), nextTaskId++);
+		queue.push_back(binding);
+	}
+
+	wakeup();
+
+	return esl::processing::Task(binding);
+}
+
+std::vector<esl::processing::Task> ProcessTaskFactory::getTasks() const {
+	std::vector<esl::processing::Task> tasks;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for(auto& binding : queue) {
+		tasks.push_back(esl::processing::Task(binding));
+	}
+	for(auto& worker : workers) {
+		if(worker && worker->binding) {
+			tasks.push_back(esl::processing::Task(worker->binding));
+		}
+	}
+
+	return tasks;
+}
+
+bool ProcessTaskFactory::cancel(ProcessBinding& binding) {
+	std::shared_ptr<ProcessWorker> worker;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for(auto iter = queue.begin(); iter != queue.end(); ++iter) {
+			if(iter->get() == &binding) {
+				queue.erase(iter);
+				return true;
+			}
+		}
+
+		for(auto& runningWorker : workers) {
+			if(runningWorker && runningWorker->binding.get() == &binding) {
+				worker = runningWorker;
+				break;
+			}
+		}
+	}
+
+	if(worker) {
+		worker->sendCancel(binding.getId());
+	}
+
+	return false;
+}
+
+void ProcessTaskFactory::start() {
+	/* The dispatcher thread is not running yet, so the template is set without holding the mutex */
+	processTemplate.reset(new ProcessTemplate(*context, { wakeupFds[0], wakeupFds[1] }));
+
+	std::vector<std::shared_ptr<ProcessWorker>> newWorkers;
+	for(unsigned int i = 0; i < processesMax; ++i) {
+		std::shared_ptr<ProcessWorker> worker = forkWorker();
+		if(worker) {
+			newWorkers.push_back(std::move(worker));
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	workers = std::move(newWorkers);
+	dispatcherThread = std::thread([this]() {
+		dispatch();
+	});
+}
+
+/* Results are received, terminated workers are replaced and tasks are sent without holding the mutex.
+ * The mutex is only held to change the bindings of the workers, the queue and the list of workers. */
+void ProcessTaskFactory::dispatch() {
+	std::vector<struct pollfd> pollFds;
+	std::vector<std::shared_ptr<ProcessWorker>> polledWorkers;
+
+	while(true) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(stopping) {
+				break;
+			}
+			polledWorkers = workers;
+		}
+
+		pollFds.clear();
+		pollFds.push_back(pollfd{ wakeupFds[0], POLLIN, 0 });
+		for(auto& worker : polledWorkers) {
+			pollFds.push_back(pollfd{ worker->getFd(), POLLIN, 0 });
+		}
+
+		if(::poll(pollFds.data(), pollFds.size(), -1) < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			logger.error << "poll failed: " << std::strerror(errno) << "\n";
+			break;
+		}
+
+		if(pollFds[0].revents != 0) {
+			char buffer[64];
+			while(::read(wakeupFds[0], buffer, sizeof(buffer)) > 0) {
+			}
+		}
+
+		std::vector<std::pair<std::shared_ptr<ProcessBinding>, esl::processing::Status>> statusChanges;
+
+		for(std::size_t i = 1; i < pollFds.size(); ++i) {
+			if(pollFds[i].revents == 0) {
+				continue;
+			}
+			std::shared_ptr<ProcessWorker>& worker = polledWorkers[i-1];
+
+			std::uint64_t taskId;
+			bool success;
+			std::string message;
+			if((pollFds[i].revents & POLLIN) && worker->receiveResult(taskId, success, message)) {
+				/* the dispatcher is the only thread that changes the binding of a worker */
+				if(worker->binding && worker->binding->getId() == taskId) {
+					if(!success) {
+						worker->binding->setException(std::make_exception_ptr(std::runtime_error(message)));
+					}
+					std::lock_guard<std::mutex> lock(mutex);
+					statusChanges.push_back(std::make_pair(std::move(worker->binding), success ? esl::processing::Status::done : esl::processing::Status::exception));
+					worker->binding.reset();
+				}
+				continue;
+			}
+
+			/* worker process terminated */
+			pid_t pid = worker->getPid();
+			logger.warn << "Worker process " << pid << " terminated, starting a new worker process.\n";
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				workers[i-1] = nullptr;
+				if(worker->binding) {
+					worker->binding->setException(std::make_exception_ptr(std::runtime_error("Worker process " + std::to_string(pid) + " terminated while running task.")));
+					statusChanges.push_back(std::make_pair(std::move(worker->binding), esl::processing::Status::exception));
+					worker->binding.reset();
+				}
+			}
+
+			/* waits for the worker process to terminate, unless a canceling thread still uses it */
+			worker.reset();
+
+			std::shared_ptr<ProcessWorker> newWorker = forkWorker();
+			std::lock_guard<std::mutex> lock(mutex);
+			workers[i-1] = std::move(newWorker);
+		}
+
+		bool workerMissing;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			/* remove workers that could not be restarted */
+			for(auto iter = workers.begin(); iter != workers.end();) {
+				iter = *iter ? std::next(iter) : workers.erase(iter);
+			}
+			workerMissing = workers.empty() && !queue.empty();
+		}
+
+		/* If no worker is left, one more attempt is made. If that fails too, the queued tasks fail
+		 * instead of waiting for a worker that will never come. */
+		if(workerMissing) {
+			std::shared_ptr<ProcessWorker> newWorker = forkWorker();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if(newWorker) {
+				workers.push_back(std::move(newWorker));
+			}
+			else {
+				for(auto& binding : queue) {
+					binding->setException(std::make_exception_ptr(std::runtime_error("No worker process available.")));
+					statusChanges.push_back(std::make_pair(std::move(binding), esl::processing::Status::exception));
+				}
+				queue.clear();
+			}
+		}
+
+		std::vector<std::shared_ptr<ProcessWorker>> runningWorkers;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for(auto& worker : workers) {
+				if(worker->binding || queue.empty()) {
+					continue;
+				}
+
+				worker->binding = std::move(queue.front());
+				queue.pop_front();
+
+				runningWorkers.push_back(worker);
+				statusChanges.push_back(std::make_pair(worker->binding, esl::processing::Status::running));
+			}
+		}
+
+		/* If sending fails the worker has terminated. This is detected by the next poll. */
+		for(auto& worker : runningWorkers) {
+			worker->sendRun(*worker->binding);
+		}
+
+		/* callbacks are called without holding the lock, so they are allowed to create new tasks */
+		for(auto& statusChange : statusChanges) {
+			if(statusChange.second != esl::processing::Status::running) {
+				statusChange.first->release();
+			}
+			statusChange.first->setStatus(statusChange.second);
+		}
+	}
+}
+
+void ProcessTaskFactory::wakeup() {
+	char c = 0;
+	while(::write(wakeupFds[1], &c, 1) < 0 && errno == EINTR) {
+	}
+}
+
+std::shared_ptr<ProcessWorker> ProcessTaskFactory::forkWorker() {
+	try {
+		return processTemplate->forkWorker();
+	}
+	catch(const std::exception& e) {
+		logger.error << "Cannot start worker process: " << e.what() << "\n";
+	}
+	return nullptr;
+}
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
@@ -0,0 +1,96 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_TASK_PROCESSTASKFACTORY_H_
+#define JBOOT_PROCESSING_TASK_PROCESSTASKFACTORY_H_
+
+#include <jboot/object/AfterInitialize.h>
+#include <jboot/processing/task/ProcessBinding.h>
+#include <jboot/processing/task/ProcessTemplate.h>
+#include <jboot/processing/task/ProcessWorker.h>
+
+#include <esl/object/Context.h>
+#include <esl/object/InitializeContext.h>
+#include <esl/processing/TaskDescriptor.h>
+#include <esl/processing/TaskFactory.h>
+#include <esl/processing/Task.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+/* Task factory that runs tasks in forked worker processes. A crashing procedure terminates its
+ * worker process only, the task gets status "exception" and the worker is replaced by a new one.
+ * Procedures of tasks must be of type ProcedureReference, so each worker resolves the procedure
+ * by its id from its own copy of the boot context. Worker processes are forked by a template process,
+ * that is forked when the initialization of the boot context has finished. */
+class ProcessTaskFactory final : public esl::processing::TaskFactory, public esl::object::InitializeContext {
+public:
+	friend class ProcessBinding;
+
+	static std::unique_ptr<esl::processing::TaskFactory> create(const std::vector<std::pair<std::string, std::string>>& settings);
+
+	ProcessTaskFactory(const std::vector<std::pair<std::string, std::string>>& settings);
+	~ProcessTaskFactory();
+
+	void initializeContext(esl::object::Context& context) override;
+
+	esl::processing::Task createTask(esl::processing::TaskDescriptor descriptor) override;
+
+	std::vector<esl::processing::Task> getTasks() const override;
+
+private:
+	unsigned int processesMax = 0;
+	esl::object::Context* context = nullptr;
+	object::AfterInitialize* afterInitialize = nullptr;
+
+	mutable std::mutex mutex; // mutable because of "getTasks() const"
+	std::list<std::shared_ptr<ProcessBinding>> queue;
+	/* Only the dispatcher thread adds or removes workers. It talks to the workers without holding the mutex,
+	 * so a removed worker is kept as nullptr until the dispatcher has finished with it. */
+	std::vector<std::shared_ptr<ProcessWorker>> workers;
+	std::uint64_t nextTaskId = 1;
+	bool stopping = false;
+
+	int wakeupFds[2] = { -1, -1 };
+	std::unique_ptr<ProcessTemplate> processTemplate;
+	std::thread dispatcherThread;
+
+	/* called by ProcessBinding::cancel(). Returns true if the task has been removed from the queue. */
+	bool cancel(ProcessBinding& binding);
+
+	void start();
+	void dispatch();
+	void wakeup();
+	std::shared_ptr<ProcessWorker> forkWorker();
+};
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_TASK_PROCESSTASKFACTORY_H_ */
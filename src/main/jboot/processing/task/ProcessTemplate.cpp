@@ -0,0 +1,231 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/task/ProcessTemplate.h>
+
+#include <esl/system/Stacktrace.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+namespace {
+const char messageFork = 'F';
+
+/* reply of the template process: pid of the worker process or -1 and errno. The socket of the worker is attached as SCM_RIGHTS. */
+struct ForkResult {
+	pid_t pid;
+	int errorNo;
+};
+
+bool sendForkResult(int fd, const ForkResult& result, int workerFd) {
+	struct iovec iov;
+	iov.iov_base = const_cast<ForkResult*>(&result);
+	iov.iov_len = sizeof(result);
+
+	alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+	struct msghdr msg;
+	std::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	if(workerFd >= 0) {
+		std::memset(control, 0, sizeof(control));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		std::memcpy(CMSG_DATA(cmsg), &workerFd, sizeof(int));
+	}
+
+	while(true) {
+		ssize_t rv = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+		if(rv < 0 && errno == EINTR) {
+			continue;
+		}
+		return rv == static_cast<ssize_t>(sizeof(result));
+	}
+}
+
+bool receiveForkResult(int fd, ForkResult& result, int& workerFd) {
+	struct iovec iov;
+	iov.iov_base = &result;
+	iov.iov_len = sizeof(result);
+
+	alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+	struct msghdr msg;
+	std::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	ssize_t rv;
+	do {
+		rv = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+	} while(rv < 0 && errno == EINTR);
+
+	workerFd = -1;
+	for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); rv > 0 && cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+			std::memcpy(&workerFd, CMSG_DATA(cmsg), sizeof(int));
+		}
+	}
+
+	return rv == static_cast<ssize_t>(sizeof(result));
+}
+
+void flushOutput() {
+	/* flush buffered output, otherwise it is written by parent and child */
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+}
+} /* anonymous namespace */
+
+ProcessTemplate::ProcessTemplate(esl::object::Context& context, const std::vector<int>& inheritedFds) {
+	int fds[2];
+	if(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+		throw esl::system::Stacktrace::add(std::runtime_error(std::string("Cannot create socket pair for template process: ") + std::strerror(errno)));
+	}
+
+	flushOutput();
+
+	pid = ::fork();
+	if(pid < 0) {
+		int errorNo = errno;
+		::close(fds[0]);
+		::close(fds[1]);
+		throw esl::system::Stacktrace::add(std::runtime_error(std::string("Cannot fork template process: ") + std::strerror(errorNo)));
+	}
+
+	if(pid == 0) {
+		::close(fds[0]);
+		for(int inheritedFd : inheritedFds) {
+			::close(inheritedFd);
+		}
+		run(fds[1], context);
+	}
+
+	::close(fds[1]);
+	fd = fds[0];
+}
+
+ProcessTemplate::~ProcessTemplate() {
+	if(fd >= 0) {
+		/* template process terminates if it reads EOF */
+		::close(fd);
+	}
+
+	if(pid > 0) {
+		int status;
+		for(int i = 0; i < 50; ++i) {
+			pid_t rv = ::waitpid(pid, &status, WNOHANG);
+			if(rv == pid || (rv < 0 && errno != EINTR)) {
+				return;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		::kill(pid, SIGKILL);
+		while(::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+		}
+	}
+}
+
+std::unique_ptr<ProcessWorker> ProcessTemplate::forkWorker() {
+	ssize_t rv;
+	do {
+		rv = ::send(fd, &messageFork, 1, MSG_NOSIGNAL);
+	} while(rv < 0 && errno == EINTR);
+
+	ForkResult result;
+	int workerFd;
+	if(rv != 1 || !receiveForkResult(fd, result, workerFd)) {
+		throw esl::system::Stacktrace::add(std::runtime_error("Template process " + std::to_string(pid) + " has terminated."));
+	}
+	if(result.pid <= 0 || workerFd < 0) {
+		if(workerFd >= 0) {
+			::close(workerFd);
+		}
+		throw esl::system::Stacktrace::add(std::runtime_error(std::string("Cannot fork worker process: ") + std::strerror(result.errorNo)));
+	}
+
+	return std::unique_ptr<ProcessWorker>(new ProcessWorker(workerFd, result.pid));
+}
+
+void ProcessTemplate::run(int fd, esl::object::Context& context) noexcept {
+	/* worker processes are reaped automatically */
+	::signal(SIGCHLD, SIG_IGN);
+
+	char request;
+	while(true) {
+		ssize_t rv = ::read(fd, &request, 1);
+		if(rv < 0 && errno == EINTR) {
+			continue;
+		}
+		if(rv != 1 || request != messageFork) {
+			break;
+		}
+
+		ForkResult result { -1, 0 };
+		int fds[2];
+		if(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+			result.errorNo = errno;
+			sendForkResult(fd, result, -1);
+			continue;
+		}
+
+		flushOutput();
+
+		result.pid = ::fork();
+		if(result.pid == 0) {
+			::signal(SIGCHLD, SIG_DFL);
+			::close(fd);
+			::close(fds[0]);
+			ProcessWorker::run(fds[1], context);
+		}
+		result.errorNo = errno;
+		::close(fds[1]);
+
+		sendForkResult(fd, result, result.pid > 0 ? fds[0] : -1);
+		::close(fds[0]);
+	}
+
+	::close(fd);
+	flushOutput();
+	::_exit(0);
+}
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
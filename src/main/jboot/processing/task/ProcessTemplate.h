@@ -0,0 +1,58 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_TASK_PROCESSTEMPLATE_H_
+#define JBOOT_PROCESSING_TASK_PROCESSTEMPLATE_H_
+
+#include <jboot/processing/task/ProcessWorker.h>
+
+#include <esl/object/Context.h>
+
+#include <memory>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+/* Single threaded process that forks the worker processes of a ProcessTaskFactory. It is forked once,
+ * after the boot context has been initialized, so the server process never forks while its threads
+ * are running and holding locks. Each worker gets a copy of the completely initialized boot context. */
+class ProcessTemplate {
+public:
+	/* inheritedFds are closed in the template process */
+	ProcessTemplate(esl::object::Context& context, const std::vector<int>& inheritedFds);
+	~ProcessTemplate();
+
+	/* Throws an exception if the template process cannot fork a worker process or has terminated */
+	std::unique_ptr<ProcessWorker> forkWorker();
+
+private:
+	int fd = -1;
+	pid_t pid = -1;
+
+	[[noreturn]] static void run(int fd, esl::object::Context& context) noexcept;
+};
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_TASK_PROCESSTEMPLATE_H_ */
@@ -0,0 +1,297 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/task/ProcessWorker.h>
+#include <jboot/processing/task/ProcedureReference.h>
+#include <jboot/object/Context.h>
+
+#include <esl/system/Stacktrace.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+namespace {
+const char messageRun = 'R';
+const char messageCancel = 'C';
+const char messageResult = 'D';
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+	while(size > 0) {
+		ssize_t rv = ::send(fd, data, size, MSG_NOSIGNAL);
+		if(rv < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		data += rv;
+		size -= static_cast<std::size_t>(rv);
+	}
+	return true;
+}
+
+bool readAll(int fd, char* data, std::size_t size) {
+	while(size > 0) {
+		ssize_t rv = ::read(fd, data, size);
+		if(rv < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if(rv == 0) {
+			return false;
+		}
+		data += rv;
+		size -= static_cast<std::size_t>(rv);
+	}
+	return true;
+}
+
+void appendUInt64(std::string& message, std::uint64_t value) {
+	message.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& message, const std::string& str) {
+	std::uint32_t size = static_cast<std::uint32_t>(str.size());
+	message.append(reinterpret_cast<const char*>(&size), sizeof(size));
+	message.append(str);
+}
+
+bool parseUInt64(const std::string& message, std::size_t& pos, std::uint64_t& value) {
+	if(pos + sizeof(value) > message.size()) {
+		return false;
+	}
+	std::memcpy(&value, message.data() + pos, sizeof(value));
+	pos += sizeof(value);
+	return true;
+}
+
+bool parseString(const std::string& message, std::size_t& pos, std::string& str) {
+	std::uint32_t size;
+	if(pos + sizeof(size) > message.size()) {
+		return false;
+	}
+	std::memcpy(&size, message.data() + pos, sizeof(size));
+	pos += sizeof(size);
+	if(pos + size > message.size()) {
+		return false;
+	}
+	str.assign(message.data() + pos, size);
+	pos += size;
+	return true;
+}
+
+bool writeMessage(int fd, const std::string& message) {
+	std::uint32_t size = static_cast<std::uint32_t>(message.size());
+	return writeAll(fd, reinterpret_cast<const char*>(&size), sizeof(size)) && writeAll(fd, message.data(), message.size());
+}
+
+bool readMessage(int fd, std::string& message) {
+	std::uint32_t size;
+	if(!readAll(fd, reinterpret_cast<char*>(&size), sizeof(size))) {
+		return false;
+	}
+	message.resize(size);
+	return size == 0 || readAll(fd, &message[0], size);
+}
+} /* anonymous namespace */
+
+ProcessWorker::ProcessWorker(int aFd, pid_t aPid)
+: fd(aFd),
+  pid(aPid)
+{ }
+
+ProcessWorker::~ProcessWorker() {
+	if(fd >= 0) {
+		/* worker process terminates if it reads EOF */
+		::close(fd);
+	}
+
+	/* The worker process is a child of the template process, that reaps it. */
+	if(pid > 0) {
+		for(int i = 0; i < 50; ++i) {
+			if(::kill(pid, 0) != 0 && errno == ESRCH) {
+				return;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		::kill(pid, SIGKILL);
+	}
+}
+
+int ProcessWorker::getFd() const noexcept {
+	return fd;
+}
+
+pid_t ProcessWorker::getPid() const noexcept {
+	return pid;
+}
+
+bool ProcessWorker::sendRun(const ProcessBinding& aBinding) {
+	const ProcedureReference& procedureReference = aBinding.getProcedureReference();
+
+	std::string message(1, messageRun);
+	appendUInt64(message, aBinding.getId());
+	appendString(message, procedureReference.getId());
+	appendUInt64(message, procedureReference.getSettings().size());
+	for(const auto& setting : procedureReference.getSettings()) {
+		appendString(message, setting.first);
+		appendString(message, setting.second);
+	}
+
+	std::lock_guard<std::mutex> lock(sendMutex);
+	return writeMessage(fd, message);
+}
+
+bool ProcessWorker::sendCancel(std::uint64_t taskId) {
+	std::string message(1, messageCancel);
+	appendUInt64(message, taskId);
+
+	std::lock_guard<std::mutex> lock(sendMutex);
+	return writeMessage(fd, message);
+}
+
+bool ProcessWorker::receiveResult(std::uint64_t& taskId, bool& success, std::string& message) {
+	std::string buffer;
+	if(!readMessage(fd, buffer) || buffer.empty() || buffer[0] != messageResult) {
+		return false;
+	}
+
+	std::size_t pos = 1;
+	std::uint64_t successValue;
+	if(!parseUInt64(buffer, pos, taskId) || !parseUInt64(buffer, pos, successValue) || !parseString(buffer, pos, message)) {
+		return false;
+	}
+	success = successValue != 0;
+	return true;
+}
+
+void ProcessWorker::run(int fd, esl::object::Context& context) noexcept {
+	std::mutex procedureMutex;
+	std::uint64_t runningTaskId = 0;
+	ProcedureReference* runningProcedure = nullptr;
+	std::thread executor;
+	std::string buffer;
+
+	while(readMessage(fd, buffer) && !buffer.empty()) {
+		std::size_t pos = 1;
+		std::uint64_t taskId;
+
+		if(buffer[0] == messageCancel) {
+			if(parseUInt64(buffer, pos, taskId)) {
+				std::lock_guard<std::mutex> lockProcedure(procedureMutex);
+				if(runningProcedure && runningTaskId == taskId) {
+					runningProcedure->procedureCancel();
+				}
+			}
+			continue;
+		}
+
+		if(buffer[0] != messageRun) {
+			break;
+		}
+
+		std::string procedureId;
+		std::uint64_t settingsSize;
+		if(!parseUInt64(buffer, pos, taskId) || !parseString(buffer, pos, procedureId) || !parseUInt64(buffer, pos, settingsSize)) {
+			break;
+		}
+
+		std::vector<std::pair<std::string, std::string>> settings;
+		bool valid = true;
+		for(std::uint64_t i = 0; i < settingsSize && valid; ++i) {
+			std::string key;
+			std::string value;
+			valid = parseString(buffer, pos, key) && parseString(buffer, pos, value);
+			settings.push_back(std::make_pair(std::move(key), std::move(value)));
+		}
+		if(!valid) {
+			break;
+		}
+
+		if(executor.joinable()) {
+			executor.join();
+		}
+
+		/* The procedure runs in a separate thread, so a cancel request can be received while it is running. */
+		executor = std::thread([fd, &context, &procedureMutex, &runningTaskId, &runningProcedure, taskId, procedureId, settings]() {
+			ProcedureReference procedureReference(procedureId, settings);
+			std::string result(1, messageResult);
+			appendUInt64(result, taskId);
+
+			try {
+				procedureReference.resolve(context);
+				{
+					std::lock_guard<std::mutex> lockProcedure(procedureMutex);
+					runningTaskId = taskId;
+					runningProcedure = &procedureReference;
+				}
+
+				object::Context taskContext;
+				procedureReference.procedureRun(taskContext);
+
+				appendUInt64(result, 1);
+				appendString(result, "");
+			}
+			catch(const std::exception& e) {
+				appendUInt64(result, 0);
+				appendString(result, e.what() ? e.what() : "");
+			}
+			catch(...) {
+				appendUInt64(result, 0);
+				appendString(result, "unknown exception");
+			}
+
+			{
+				std::lock_guard<std::mutex> lockProcedure(procedureMutex);
+				runningProcedure = nullptr;
+			}
+			writeMessage(fd, result);
+		});
+	}
+
+	if(executor.joinable()) {
+		executor.join();
+	}
+	::close(fd);
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+	::_exit(0);
+}
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
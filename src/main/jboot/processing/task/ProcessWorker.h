@@ -0,0 +1,69 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_TASK_PROCESSWORKER_H_
+#define JBOOT_PROCESSING_TASK_PROCESSWORKER_H_
+
+#include <jboot/processing/task/ProcessBinding.h>
+
+#include <esl/object/Context.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <sys/types.h>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+/* Handle of a worker process of a ProcessTaskFactory. Worker processes are forked by the ProcessTemplate.
+ * Parent and worker communicate through a unix socket pair with length prefixed messages. */
+class ProcessWorker {
+public:
+	friend class ProcessTemplate;
+
+	ProcessWorker(int fd, pid_t pid);
+	~ProcessWorker();
+
+	int getFd() const noexcept;
+	pid_t getPid() const noexcept;
+
+	bool sendRun(const ProcessBinding& binding);
+	bool sendCancel(std::uint64_t taskId);
+	bool receiveResult(std::uint64_t& taskId, bool& success, std::string& message);
+
+	std::shared_ptr<ProcessBinding> binding;
+
+private:
+	int fd = -1;
+	pid_t pid = -1;
+
+	/* serializes sendRun of the dispatcher and sendCancel of other threads */
+	std::mutex sendMutex;
+
+	[[noreturn]] static void run(int fd, esl::object::Context& context) noexcept;
+};
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_TASK_PROCESSWORKER_H_ */
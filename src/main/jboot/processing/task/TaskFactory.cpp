@@ -17,11 +17,19 @@
  */
 
 #include <jboot/processing/task/TaskFactory.h>
+#include <jboot/processing/task/ProcedureReference.h>
+#include <jboot/Logger.h>
+
+#include <stdexcept>
 
 namespace jboot {
 namespace processing {
 namespace task {
 
+namespace {
+Logger logger("jboot::processing::task::TaskFactory");
+}
+
 std::unique_ptr<esl::processing::TaskFactory> TaskFactory::create(const std::vector<std::pair<std::string, std::string>>& settings) {
 	return std::unique_ptr<esl::processing::TaskFactory>(new TaskFactory(settings));
 }
@@ -58,6 +66,26 @@ TaskFactory::TaskFactory(const std::vector<std::pair<std::string, std::string>>&
 			}
 			threadTimeout = std::chrono::milliseconds(threadTimeoutMs);
 		}
+		else if(setting.first == "wal-file") {
+			if(!walFile.empty()) {
+		        throw std::runtime_error("multiple definition of attribute 'wal-file'.");
+			}
+			walFile = setting.second;
+			if(walFile.empty()) {
+		    	throw std::runtime_error("Invalid value \"\" for key 'wal-file'.");
+			}
+		}
+		else if(setting.first == "wal-group-commit-ms") {
+			if(hasWalGroupCommit) {
+		        throw std::runtime_error("multiple definition of attribute 'wal-group-commit-ms'.");
+			}
+			hasWalGroupCommit = true;
+			long walGroupCommitMs = std::stol(setting.second);
+			if(walGroupCommitMs < 0) {
+		    	throw std::runtime_error("Invalid value \"" + setting.second + "\" for key 'wal-group-commit-ms'. Value must be >= 0");
+			}
+			walGroupCommit = std::chrono::milliseconds(walGroupCommitMs);
+		}
 		else {
             throw std::runtime_error("unknown attribute '\"" + setting.first + "\"'.");
 		}
@@ -67,6 +95,13 @@ TaskFactory::TaskFactory(const std::vector<std::pair<std::string, std::string>>&
         throw std::runtime_error("Definition of 'max-threads' is missing.");
 	}
 
+	if(hasWalGroupCommit && walFile.empty()) {
+        throw std::runtime_error("Definition of 'wal-group-commit-ms' requires definition of 'wal-file'.");
+	}
+
+	if(!walFile.empty()) {
+		writeAheadLog.reset(new WriteAheadLog(walFile, walGroupCommit));
+	}
 }
 
 TaskFactory::~TaskFactory() {
@@ -88,13 +123,67 @@ TaskFactory::~TaskFactory() {
 	});
 }
 
+void TaskFactory::initializeContext(esl::object::Context& aContext) {
+	if(context) {
+		return;
+	}
+	context = &aContext;
+
+	if(!writeAheadLog) {
+		return;
+	}
+
+	std::vector<WriteAheadLog::Task> walTasks = writeAheadLog->recover();
+	if(!walTasks.empty()) {
+		logger.info << "Replaying " << walTasks.size() << " tasks from write ahead log \"" << walFile << "\"\n";
+	}
+
+	for(auto& walTask : walTasks) {
+		std::unique_ptr<ProcedureReference> procedureReference(new ProcedureReference(std::move(walTask.procedureId), std::move(walTask.settings)));
+		try {
+			procedureReference->resolve(*context);
+		}
+		catch(const std::exception& e) {
+			logger.warn << "Dropping task " << walTask.id << " from write ahead log: " << e.what() << "\n";
+			writeAheadLog->complete(walTask.id, esl::processing::Status::exception);
+			continue;
+		}
+
+		esl::processing::TaskDescriptor descriptor;
+		descriptor.procedure = std::move(procedureReference);
+		addTask(std::move(descriptor), walTask.id);
+	}
+}
+
 esl::processing::Task TaskFactory::createTask(esl::processing::TaskDescriptor descriptor) {
+	std::uint64_t walId = 0;
+
+	ProcedureReference* procedureReference = dynamic_cast<ProcedureReference*>(descriptor.procedure.get());
+	if(procedureReference) {
+		if(!procedureReference->isResolved() && context) {
+			procedureReference->resolve(*context);
+		}
+
+		if(writeAheadLog) {
+			if(!context) {
+				throw std::runtime_error("jboot: TaskFactory with attribute 'wal-file' has not been initialized.");
+			}
+
+			/* returns after the task is written to disk */
+			walId = writeAheadLog->append(*procedureReference);
+		}
+	}
+
+	return addTask(std::move(descriptor), walId);
+}
+
+esl::processing::Task TaskFactory::addTask(esl::processing::TaskDescriptor descriptor, std::uint64_t walId) {
 	std::shared_ptr<esl::processing::Task::Binding> binding;
 
 	{
 		std::lock_guard<std::mutex> lockQueueMutex(queueMutex);
 
-		std::unique_ptr<Binding> bindingTmp(new Binding(*this, std::move(descriptor)));
+		std::unique_ptr<Binding> bindingTmp(new Binding(*this, std::move(descriptor), walId));
 		Binding* bindingPtr = bindingTmp.get();
 		binding = std::shared_ptr<esl::processing::Task::Binding>(bindingTmp.release());
 		queue.push_back(std::make_pair(bindingPtr, binding));
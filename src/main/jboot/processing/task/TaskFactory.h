@@ -19,8 +19,13 @@
 #ifndef JBOOT_PROCESSING_TASK_TASKFACTORY_H_
 #define JBOOT_PROCESSING_TASK_TASKFACTORY_H_
 
+#include <jboot/object/Reusable.h>
 #include <jboot/processing/task/Binding.h>
 #include <jboot/processing/task/Thread.h>
+#include <jboot/processing/task/WriteAheadLog.h>
+
+#include <esl/object/Context.h>
+#include <esl/object/InitializeContext.h>
 
 #include <esl/processing/TaskDescriptor.h>
 #include <esl/processing/TaskFactory.h>
@@ -29,9 +34,11 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <condition_variable>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -43,7 +50,9 @@ namespace jboot {
 namespace processing {
 namespace task {
 
-class TaskFactory final : public esl::processing::TaskFactory {
+/* Procedures are resolved by the context when a task is created, so reload of the boot context keeps
+ * the task factory and its write ahead log if the configuration of the factory has not been changed. */
+class TaskFactory final : public esl::processing::TaskFactory, public esl::object::InitializeContext, public object::Reusable {
 public:
 	friend class Binding;
 	friend class Thread;
@@ -53,11 +62,26 @@ public:
 	TaskFactory(const std::vector<std::pair<std::string, std::string>>& settings);
 	~TaskFactory();
 
+	void initializeContext(esl::object::Context& context) override;
+
 	esl::processing::Task createTask(esl::processing::TaskDescriptor descriptor) override;
 
 	std::vector<esl::processing::Task> getTasks() const override;
 
 private:
+	esl::object::Context* context = nullptr;
+
+	/* Tasks with a ProcedureReference are written to this log if attribute 'wal-file' is defined.
+	 * Tasks that are still queued when the TaskFactory gets destroyed get no completion record,
+	 * so they are queued again by initializeContext() after restart. Only one task factory can use
+	 * the log at a time, even across processes. */
+	std::string walFile;
+	bool hasWalGroupCommit = false;
+	std::chrono::milliseconds walGroupCommit { 0 };
+	std::unique_ptr<WriteAheadLog> writeAheadLog;
+
+	esl::processing::Task addTask(esl::processing::TaskDescriptor descriptor, std::uint64_t walId);
+
 	mutable std::mutex queueMutex; // mutable because of "getTasks() const"
 	std::list<std::pair<Binding*, std::shared_ptr<esl::processing::Task::Binding>>> queue;
 
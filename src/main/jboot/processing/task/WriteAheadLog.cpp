@@ -0,0 +1,376 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <jboot/processing/task/WriteAheadLog.h>
+#include <jboot/Logger.h>
+
+#include <esl/system/Stacktrace.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+namespace {
+Logger logger("jboot::processing::task::WriteAheadLog");
+
+const char recordQueued = 'Q';
+const char recordCompleted = 'D';
+
+std::uint32_t checksum(const char* data, std::size_t size) {
+	/* FNV-1a */
+	std::uint32_t hash = 2166136261u;
+	for(std::size_t i = 0; i < size; ++i) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void appendUInt32(std::string& buffer, std::uint32_t value) {
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendUInt64(std::string& buffer, std::uint64_t value) {
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& buffer, const std::string& str) {
+	appendUInt32(buffer, static_cast<std::uint32_t>(str.size()));
+	buffer.append(str);
+}
+
+template<typename T>
+bool parseValue(const std::string& buffer, std::size_t& pos, T& value) {
+	if(pos + sizeof(value) > buffer.size()) {
+		return false;
+	}
+	std::memcpy(&value, buffer.data() + pos, sizeof(value));
+	pos += sizeof(value);
+	return true;
+}
+
+bool parseString(const std::string& buffer, std::size_t& pos, std::string& str) {
+	std::uint32_t size;
+	if(!parseValue(buffer, pos, size) || pos + size > buffer.size()) {
+		return false;
+	}
+	str.assign(buffer.data() + pos, size);
+	pos += size;
+	return true;
+}
+
+std::string makeQueuedPayload(const WriteAheadLog::Task& task) {
+	std::string payload(1, recordQueued);
+	appendUInt64(payload, task.id);
+	appendString(payload, task.procedureId);
+	appendUInt32(payload, static_cast<std::uint32_t>(task.settings.size()));
+	for(const auto& setting : task.settings) {
+		appendString(payload, setting.first);
+		appendString(payload, setting.second);
+	}
+	return payload;
+}
+
+bool writeAll(int fd, const std::string& data) {
+	std::size_t pos = 0;
+	while(pos < data.size()) {
+		ssize_t rv = ::write(fd, data.data() + pos, data.size() - pos);
+		if(rv < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		pos += static_cast<std::size_t>(rv);
+	}
+	return true;
+}
+
+void syncDirectory(const std::string& fileName) {
+	std::string path(fileName);
+	std::string directory(::dirname(&path[0]));
+
+	int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if(fd >= 0) {
+		::fsync(fd);
+		::close(fd);
+	}
+}
+/* Returns a descriptor of the file that holds an exclusive lock */
+int lockFile(const std::string& fileName) {
+	while(true) {
+		int fd = ::open(fileName.c_str(), O_RDONLY | O_CREAT | O_CLOEXEC, 0644);
+		if(fd < 0) {
+			throw esl::system::Stacktrace::add(std::runtime_error("Cannot open file \"" + fileName + "\": " + std::strerror(errno)));
+		}
+
+		if(::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+			int errorNo = errno;
+			::close(fd);
+			if(errorNo == EWOULDBLOCK) {
+				throw esl::system::Stacktrace::add(std::runtime_error("Write ahead log \"" + fileName + "\" is used by another task factory."));
+			}
+			throw esl::system::Stacktrace::add(std::runtime_error("Cannot lock file \"" + fileName + "\": " + std::strerror(errorNo)));
+		}
+
+		/* The file might have been replaced by the compacted log of the previous owner meanwhile */
+		struct stat lockedStat;
+		struct stat currentStat;
+		if(::fstat(fd, &lockedStat) == 0 && ::stat(fileName.c_str(), &currentStat) == 0
+		&& lockedStat.st_dev == currentStat.st_dev && lockedStat.st_ino == currentStat.st_ino) {
+			return fd;
+		}
+		::close(fd);
+	}
+}
+} /* anonymous namespace */
+
+WriteAheadLog::WriteAheadLog(const std::string& aFileName, std::chrono::milliseconds aGroupCommitDelay)
+: fileName(aFileName),
+  groupCommitDelay(aGroupCommitDelay)
+{ }
+
+WriteAheadLog::~WriteAheadLog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	writerCV.notify_all();
+
+	if(writerThread.joinable()) {
+		writerThread.join();
+	}
+
+	if(fd >= 0) {
+		::close(fd);
+	}
+	if(lockFd >= 0) {
+		::close(lockFd);
+	}
+}
+
+std::vector<WriteAheadLog::Task> WriteAheadLog::recover() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(fd >= 0) {
+		throw std::runtime_error("Write ahead log \"" + fileName + "\" has been recovered already.");
+	}
+
+	/* The lock is kept until the log is closed. Otherwise a second task factory for the same file would
+	 * replace the log by a compacted copy, while this one is still appending to it. */
+	if(lockFd < 0) {
+		lockFd = lockFile(fileName);
+	}
+
+	std::string content;
+	{
+		std::ifstream file(fileName, std::ios::binary);
+		content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	std::map<std::uint64_t, Task> tasks;
+	std::size_t pos = 0;
+	while(pos < content.size()) {
+		std::uint32_t size;
+		std::uint32_t sum;
+		std::size_t recordPos = pos;
+		if(!parseValue(content, recordPos, size) || !parseValue(content, recordPos, sum) || recordPos + size > content.size()
+		|| size == 0 || checksum(content.data() + recordPos, size) != sum) {
+			/* a torn write of the last batch before a crash. These tasks have never been confirmed. */
+			logger.warn << "Ignoring " << (content.size() - pos) << " bytes of incomplete records at the end of write ahead log \"" << fileName << "\"\n";
+			break;
+		}
+
+		std::string payload(content.data() + recordPos, size);
+		pos = recordPos + size;
+
+		std::size_t payloadPos = 1;
+		std::uint64_t id;
+		if(!parseValue(payload, payloadPos, id)) {
+			continue;
+		}
+		if(id >= nextId) {
+			nextId = id + 1;
+		}
+
+		if(payload[0] == recordQueued) {
+			Task task;
+			std::uint32_t settingsSize;
+			task.id = id;
+			if(!parseString(payload, payloadPos, task.procedureId) || !parseValue(payload, payloadPos, settingsSize)) {
+				continue;
+			}
+			bool valid = true;
+			for(std::uint32_t i = 0; i < settingsSize && valid; ++i) {
+				std::pair<std::string, std::string> setting;
+				valid = parseString(payload, payloadPos, setting.first) && parseString(payload, payloadPos, setting.second);
+				task.settings.push_back(std::move(setting));
+			}
+			if(valid) {
+				tasks[id] = std::move(task);
+			}
+		}
+		else if(payload[0] == recordCompleted) {
+			tasks.erase(id);
+		}
+	}
+
+	/* compact the log: write pending tasks only to a new file and replace the old one */
+	std::string tmpFileName = fileName + ".tmp";
+	int tmpFd = ::open(tmpFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(tmpFd < 0) {
+		throw esl::system::Stacktrace::add(std::runtime_error("Cannot create file \"" + tmpFileName + "\": " + std::strerror(errno)));
+	}
+	/* the new file is locked before it replaces the old one, so it is never visible without lock */
+	if(::flock(tmpFd, LOCK_EX | LOCK_NB) != 0) {
+		int errorNo = errno;
+		::close(tmpFd);
+		throw esl::system::Stacktrace::add(std::runtime_error("Cannot lock file \"" + tmpFileName + "\": " + std::strerror(errorNo)));
+	}
+
+	std::vector<Task> rv;
+	std::string data;
+	for(auto& task : tasks) {
+		std::string payload = makeQueuedPayload(task.second);
+		appendUInt32(data, static_cast<std::uint32_t>(payload.size()));
+		appendUInt32(data, checksum(payload.data(), payload.size()));
+		data += payload;
+		rv.push_back(std::move(task.second));
+	}
+
+	bool success = writeAll(tmpFd, data) && ::fsync(tmpFd) == 0;
+	if(!success || ::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+		int errorNo = errno;
+		::close(tmpFd);
+		throw esl::system::Stacktrace::add(std::runtime_error("Cannot write file \"" + fileName + "\": " + std::strerror(errorNo)));
+	}
+	syncDirectory(fileName);
+
+	/* the lock of the replaced file is not needed anymore */
+	::close(lockFd);
+	lockFd = tmpFd;
+
+	fd = ::open(fileName.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+	if(fd < 0) {
+		throw esl::system::Stacktrace::add(std::runtime_error("Cannot open file \"" + fileName + "\": " + std::strerror(errno)));
+	}
+
+	writerThread = std::thread([this]() {
+		write();
+	});
+
+	return rv;
+}
+
+std::uint64_t WriteAheadLog::append(const ProcedureReference& procedureReference) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if(fd < 0) {
+		throw std::runtime_error("Write ahead log \"" + fileName + "\" has not been recovered.");
+	}
+
+	Task task;
+	task.id = nextId++;
+	task.procedureId = procedureReference.getId();
+	task.settings = procedureReference.getSettings();
+	addRecord(makeQueuedPayload(task));
+
+	std::uint64_t batch = batchCurrent;
+	writerCV.notify_one();
+	syncedCV.wait(lock, [this, batch]() {
+		return batchSynced >= batch || hasError;
+	});
+
+	if(hasError) {
+		throw std::runtime_error("Cannot write to write ahead log \"" + fileName + "\".");
+	}
+
+	return task.id;
+}
+
+void WriteAheadLog::complete(std::uint64_t id, esl::processing::Status status) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(fd < 0) {
+		return;
+	}
+
+	std::string payload(1, recordCompleted);
+	appendUInt64(payload, id);
+	payload += static_cast<char>(status);
+	addRecord(payload);
+
+	writerCV.notify_one();
+}
+
+void WriteAheadLog::write() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while(true) {
+		writerCV.wait(lock, [this]() {
+			return stopping || !buffer.empty();
+		});
+		if(buffer.empty()) {
+			break;
+		}
+
+		if(groupCommitDelay.count() > 0 && !stopping) {
+			writerCV.wait_for(lock, groupCommitDelay, [this]() {
+				return stopping;
+			});
+		}
+
+		std::string data;
+		data.swap(buffer);
+		std::uint64_t batch = batchCurrent++;
+
+		lock.unlock();
+		bool success = writeAll(fd, data) && ::fdatasync(fd) == 0;
+		lock.lock();
+
+		if(!success) {
+			logger.error << "Cannot write to write ahead log \"" << fileName << "\": " << std::strerror(errno) << "\n";
+			hasError = true;
+		}
+		batchSynced = batch;
+		syncedCV.notify_all();
+	}
+}
+
+void WriteAheadLog::addRecord(const std::string& payload) {
+	appendUInt32(buffer, static_cast<std::uint32_t>(payload.size()));
+	appendUInt32(buffer, checksum(payload.data(), payload.size()));
+	buffer += payload;
+}
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
@@ -0,0 +1,89 @@
+/*
+ * This file is part of JBoot framework.
+ * Copyright (C) 2022 Sven Lukas
+ *
+ * JBoot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * JBoot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License along with JBoot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JBOOT_PROCESSING_TASK_WRITEAHEADLOG_H_
+#define JBOOT_PROCESSING_TASK_WRITEAHEADLOG_H_
+
+#include <jboot/processing/task/ProcedureReference.h>
+
+#include <esl/processing/Status.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jboot {
+namespace processing {
+namespace task {
+
+/* Append only log of queued and completed tasks of a TaskFactory.
+ * Appending a task returns as soon as the record is on disk. Records of concurrent callers are
+ * written and synced together (group commit), so one fdatasync is shared by all tasks that have
+ * been queued while the previous sync was running. */
+class WriteAheadLog {
+public:
+	struct Task {
+		std::uint64_t id;
+		std::string procedureId;
+		std::vector<std::pair<std::string, std::string>> settings;
+	};
+
+	WriteAheadLog(const std::string& fileName, std::chrono::milliseconds groupCommitDelay);
+	~WriteAheadLog();
+
+	/* Returns all tasks without completion record in the order they have been queued
+	 * and rewrites the log file with these tasks only. Throws an exception if another
+	 * WriteAheadLog has the file already. */
+	std::vector<Task> recover();
+
+	std::uint64_t append(const ProcedureReference& procedureReference);
+	void complete(std::uint64_t id, esl::processing::Status status);
+
+private:
+	const std::string fileName;
+	const std::chrono::milliseconds groupCommitDelay;
+	int fd = -1;
+	/* holds the exclusive lock of the log file */
+	int lockFd = -1;
+
+	std::mutex mutex;
+	std::condition_variable writerCV;
+	std::condition_variable syncedCV;
+	std::string buffer;
+	std::uint64_t nextId = 1;
+	std::uint64_t batchCurrent = 1;
+	std::uint64_t batchSynced = 0;
+	bool hasError = false;
+	bool stopping = false;
+	std::thread writerThread;
+
+	void open();
+	void write();
+	void addRecord(const std::string& payload);
+};
+
+} /* namespace task */
+} /* namespace processing */
+} /* namespace jboot */
+
+#endif /* JBOOT_PROCESSING_TASK_WRITEAHEADLOG_H_ */